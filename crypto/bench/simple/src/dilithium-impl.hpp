@@ -0,0 +1,4 @@
+#pragma once
+
+#include <dory/crypto/asymmetric/dilithium.hpp>
+#define crypto_impl dory::crypto::asymmetric::dilithium
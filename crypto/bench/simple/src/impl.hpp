@@ -5,6 +5,9 @@
 #elif defined(SODIUM)
 #undef DALEK_LEGACY
 #include "sodium-impl.hpp"
+#elif defined(DILITHIUM) || defined(DILITHIUM_REF)
+#undef DALEK_LEGACY
+#include "dilithium-impl.hpp"
 #else
-#error "Define DALEK or SODIUM"
+#error "Define DALEK, SODIUM, DILITHIUM or DILITHIUM_REF"
 #endif
@@ -1,5 +1,7 @@
+#include <array>
 #include <chrono>
 #include <iostream>
+#include <vector>
 
 #include <dory/shared/logger.hpp>
 
@@ -88,7 +90,14 @@ int main() {
   keypair_free(kp);
 
 #else
+#ifdef DILITHIUM_REF
+  crypto_impl::force_portable();
+#endif
   crypto_impl::init();
+#if defined(DILITHIUM) || defined(DILITHIUM_REF)
+  logger->info("Using the {} implementation of Dilithium",
+               crypto_impl::avx2() ? "AVX2" : "portable");
+#endif
 
   crypto_impl::publish_pub_key_nostore("p1-pk");
 
@@ -135,6 +144,81 @@ int main() {
     sign_microseconds =
         std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
   }
+
+#ifdef DALEK
+  {
+    // A batch of distinct messages must verify, and fail as soon as one of its
+    // signatures or messages is tampered with.
+    size_t constexpr BatchSize = 16;
+    auto pk = crypto_impl::get_public_key_nostore("p1-pk");
+    std::vector<std::array<unsigned char, 12>> batch_msgs(BatchSize);
+    std::vector<std::array<unsigned char, crypto_impl::SignatureLength>>
+        batch_sigs(BatchSize);
+    std::vector<unsigned char const*> sigs;
+    std::vector<unsigned char const*> msgs;
+    std::vector<uint64_t> msg_lens(BatchSize, 12);
+    std::vector<crypto_impl::publickey_t const*> pks(BatchSize, pk.get());
+    for (size_t i = 0; i < BatchSize; i++) {
+      batch_msgs[i].fill(static_cast<unsigned char>(i));
+      crypto_impl::sign(batch_sigs[i].data(), batch_msgs[i].data(),
+                        batch_msgs[i].size());
+      sigs.push_back(batch_sigs[i].data());
+      msgs.push_back(batch_msgs[i].data());
+    }
+    auto const batch_valid = [&]() {
+      return crypto_impl::verify_batch(sigs.data(), msgs.data(),
+                                       msg_lens.data(), pks.data(), BatchSize);
+    };
+
+    if (!batch_valid()) {
+      logger->error("Error in batch verifying valid signatures");
+      return 1;
+    }
+    batch_sigs[BatchSize / 2][0] ^= 1;
+    if (batch_valid()) {
+      logger->error("Batch verification accepted a tampered signature");
+      return 1;
+    }
+    batch_sigs[BatchSize / 2][0] ^= 1;
+    batch_msgs.back()[0] ^= 1;
+    if (batch_valid()) {
+      logger->error("Batch verification accepted a tampered message");
+      return 1;
+    }
+    batch_msgs.back()[0] ^= 1;
+  }
+
+  {
+    size_t constexpr BatchSize = 64;
+    auto pk = crypto_impl::get_public_key_nostore("p1-pk");
+    std::vector<unsigned char const*> sigs(BatchSize, sig);
+    std::vector<unsigned char const*> msgs(
+        BatchSize, reinterpret_cast<unsigned char const*>(msg));
+    std::vector<uint64_t> msg_lens(BatchSize, msg_len);
+    std::vector<crypto_impl::publickey_t const*> pks(BatchSize, pk.get());
+
+    int successes = 0;
+    int const batches = iterations / static_cast<int>(BatchSize);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < batches; i++) {
+      successes += crypto_impl::verify_batch(sigs.data(), msgs.data(),
+                                             msg_lens.data(), pks.data(),
+                                             BatchSize);
+    }
+    auto elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    if (successes != batches) {
+      logger->error("Error in batch verifying ({} vs {})", successes, batches);
+      return 1;
+    }
+
+    logger->info(
+        "Batch verification takes {} us per signature (batches of {})",
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() /
+            (batches * static_cast<int>(BatchSize)),
+        BatchSize);
+  }
+#endif
 #endif
 
   logger->info("Verification takes {} us", verify_microseconds / iterations);
@@ -1,9 +1,12 @@
 #[macro_use]
 extern crate ed25519_dalek;
 
+extern crate curve25519_dalek;
 extern crate rand;
 extern crate libc;
 
+use curve25519_dalek::edwards::CompressedEdwardsY;
+
 use ed25519_dalek::ExpandedSecretKey;
 use ed25519_dalek::Keypair;
 use ed25519_dalek::PublicKey;
@@ -225,6 +228,77 @@ pub extern "C" fn publickey_verify(
     }
 }
 
+// Whether the encoded point is of small order or not a point at all.
+fn is_small_order(compressed: &[u8]) -> bool {
+    match CompressedEdwardsY::from_slice(compressed).decompress() {
+        Some(point) => point.is_small_order(),
+        None => true,
+    }
+}
+
+/// Returns 1 if, for all `i < n`, `signatures[i]` signs `msgs[i][0..lens[i])`
+/// under `pks[i]`, checking them together with a single multiscalar
+/// multiplication.
+///
+/// As `verify_strict`, it rejects small-order R and A, which the batch equation
+/// alone does not. A 0 only means that one of them is invalid.
+#[no_mangle]
+pub extern "C" fn publickeys_verify_batch(
+    pks: *const *const PublicKey,
+    msgs: *const *const u8,
+    lens: *const size_t,
+    signatures: *const *const u8,
+    n: size_t,
+) -> u8 {
+    let (pks, msgs, lens, signatures) = unsafe {
+        assert!(!pks.is_null() && !msgs.is_null() && !lens.is_null() && !signatures.is_null());
+        (
+            slice::from_raw_parts(pks, n as usize),
+            slice::from_raw_parts(msgs, n as usize),
+            slice::from_raw_parts(lens, n as usize),
+            slice::from_raw_parts(signatures, n as usize),
+        )
+    };
+
+    let mut public_keys = Vec::with_capacity(n as usize);
+    for &pk in pks {
+        let public_key = unsafe {
+            assert!(!pk.is_null());
+            &*pk
+        };
+        if is_small_order(public_key.as_bytes()) {
+            return 0;
+        }
+        public_keys.push(public_key.clone());
+    }
+
+    let messages: Vec<&[u8]> = msgs
+        .iter()
+        .zip(lens)
+        .map(|(&msg, &len)| unsafe {
+            assert!(!msg.is_null());
+            slice::from_raw_parts(msg, len as usize)
+        })
+        .collect();
+
+    let mut sigs = Vec::with_capacity(n as usize);
+    for &signature in signatures {
+        let sig_ref = unsafe {
+            assert!(!signature.is_null());
+            slice::from_raw_parts(signature, sl as usize)
+        };
+        if is_small_order(&sig_ref[..32]) {
+            return 0;
+        }
+        sigs.push(Signature::new(sig_ref.try_into().expect("Incorrect signature length")));
+    }
+
+    match verify_batch(&messages[..], &sigs[..], &public_keys[..]) {
+        Ok(_) => 1,
+            _ => 0,
+    }
+}
+
 #[cfg(test)]
 mod tests {
     #[test]
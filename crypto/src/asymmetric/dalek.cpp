@@ -39,6 +39,11 @@ extern uint8_t publickey_verify_raw(publickey_t *keypair, uint8_t const *msg,
 extern uint8_t publickey_verify(
     publickey_t *public_key, uint8_t const *msg, size_t len,
     dory::crypto::asymmetric::dalek::signature const *sig);
+extern uint8_t publickeys_verify_batch(publickey_t const *const *public_keys,
+                                       uint8_t const *const *msgs,
+                                       size_t const *lens,
+                                       uint8_t const *const *raw_sigs,
+                                       size_t n);
 }
 
 auto logger = dory::std_out_logger("CRYPTO");
@@ -62,6 +67,11 @@ void init() {
                                    [](keypair *rkp) { keypair_free(rkp); });
 }
 
+priv_key new_keypair() {
+  return deleted_unique_ptr<keypair>(keypair_create(),
+                                     [](keypair *rkp) { keypair_free(rkp); });
+}
+
 bool avx() {
 #ifdef DALEK_AVX
   return true;
@@ -76,6 +86,12 @@ void publish_pub_key(std::string const &mem_key) {
                            PublicKeyLength));
 }
 
+void publish_pub_key(std::string const &mem_key, priv_key const &kp) {
+  dory::memstore::MemoryStore::getInstance().set(
+      mem_key, std::string(reinterpret_cast<char *>(public_part(kp.get())),
+                           PublicKeyLength));
+}
+
 void publish_pub_key_nostore(std::string const &mem_key) {
   nostore_map.set(mem_key,
                   std::string(reinterpret_cast<char *>(public_part(kp.get())),
@@ -136,6 +152,11 @@ void sign(unsigned char *buf, unsigned char const *msg, uint64_t msg_len) {
   return keypair_sign_into(buf, kp.get(), msg, msg_len);
 }
 
+void sign(unsigned char *buf, unsigned char const *msg, uint64_t msg_len,
+          priv_key const &kp) {
+  keypair_sign_into(buf, kp.get(), msg, msg_len);
+}
+
 bool verify(signature const &sig, unsigned char const *msg, uint64_t msg_len,
             pub_key &pk) {
   return publickey_verify(pk.get(), msg, msg_len, &sig);
@@ -147,4 +168,16 @@ bool verify(unsigned char const *sig, unsigned char const *msg,
                               reinterpret_cast<uint8_t const *>(sig));
 }
 
+bool verify_batch(unsigned char const *const *sigs,
+                  unsigned char const *const *msgs, uint64_t const *msg_lens,
+                  publickey_t const *const *pks, size_t n) {
+  if (n == 0) {
+    return true;
+  }
+  static_assert(sizeof(uint64_t) == sizeof(size_t));
+  return publickeys_verify_batch(pks, msgs,
+                                 reinterpret_cast<size_t const *>(msg_lens),
+                                 sigs, n);
+}
+
 }  // namespace dory::crypto::asymmetric::dalek
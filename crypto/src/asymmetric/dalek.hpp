@@ -10,6 +10,7 @@ namespace dory::crypto::asymmetric::dalek {
 
 extern "C" {
 typedef struct publickey publickey_t;  // NOLINT
+typedef struct keypair keypair_t;      // NOLINT
 }
 
 // extern "C" {
@@ -25,6 +26,7 @@ static size_t constexpr KeypairLenngth = 64;
 static size_t constexpr SignatureLength = 64;
 
 using pub_key = deleted_unique_ptr<publickey>;
+using priv_key = deleted_unique_ptr<keypair>;
 
 using signature = struct Sig { uint8_t s[SignatureLength]; };
 
@@ -33,6 +35,11 @@ using signature = struct Sig { uint8_t s[SignatureLength]; };
  **/
 void init();
 
+/**
+ * Creates a keypair besides the local one (e.g., to sign as another identity)
+ **/
+priv_key new_keypair();
+
 /**
  * Returns whether the Dalek implementation is accelerated
  */
@@ -44,6 +51,12 @@ bool avx();
  **/
 void publish_pub_key(std::string const &mem_key);
 
+/**
+ * Publishes the public part of `kp` under the key `mem_key` to the central
+ * registry
+ **/
+void publish_pub_key(std::string const &mem_key, priv_key const &kp);
+
 /**
  * Publishes the public part of the local keypair under the key `mem_key` to
  * a thread-safe map
@@ -91,6 +104,13 @@ signature sign(unsigned char const *msg, uint64_t msg_len);
  **/
 void sign(unsigned char *buf, unsigned char const *msg, uint64_t msg_len);
 
+/**
+ * Signs the provided message with the private key of `kp`. The signature is
+ * stored in the memory pointed to by buf.
+ **/
+void sign(unsigned char *buf, unsigned char const *msg, uint64_t msg_len,
+          priv_key const &kp);
+
 /**
  * Verifies that the signature of msg was created with the secret key matching
  * the public key `pk`.
@@ -119,4 +139,23 @@ bool verify(signature const &sig, unsigned char const *msg, uint64_t msg_len,
 bool verify(unsigned char const *sig, unsigned char const *msg,
             uint64_t msg_len, pub_key &pk);
 
+/**
+ * Verifies `n` signatures at once: that `sigs[i]` is a signature of
+ * `msgs[i][0..msg_lens[i])` under `pks[i]`, for all `i`. Cheaper than `n` calls
+ * to `verify` as all the signatures are checked with a single multiscalar
+ * multiplication.
+ *
+ * @param sigs: pointers to the `SignatureLength`-byte signatures
+ * @param msgs: pointers to the messages
+ * @param msg_lens: lengths of the messages
+ * @param pks: pointers to the public keys (e.g., `pub_key::get()`)
+ * @param n: number of signatures
+ *
+ * @returns true if all signatures are valid. On false, at least one is
+ *          invalid: `verify` tells which.
+ **/
+bool verify_batch(unsigned char const *const *sigs,
+                  unsigned char const *const *msgs, uint64_t const *msg_lens,
+                  publickey_t const *const *pks, size_t n);
+
 }  // namespace dory::crypto::asymmetric::dalek
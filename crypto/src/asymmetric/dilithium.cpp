@@ -11,6 +11,34 @@
 namespace dory::crypto::asymmetric::dilithium {
 
 auto logger = dory::std_out_logger("CRYPTO");
+
+struct Impl {
+  int (*keypair)(uint8_t* pk, uint8_t* sk);
+  int (*signature)(uint8_t* sig, size_t* siglen, uint8_t const* m, size_t mlen,
+                   uint8_t const* sk);
+  int (*verify)(uint8_t const* sig, size_t siglen, uint8_t const* m,
+                size_t mlen, uint8_t const* pk);
+};
+
+static Impl constexpr Avx2Impl = {pqcrystals_dilithium2aes_avx2_keypair,
+                                  pqcrystals_dilithium2aes_avx2_signature,
+                                  pqcrystals_dilithium2aes_avx2_verify};
+
+static Impl constexpr PortableImpl = {pqcrystals_dilithium2aes_ref_keypair,
+                                      pqcrystals_dilithium2aes_ref_signature,
+                                      pqcrystals_dilithium2aes_ref_verify};
+
+static Impl const* detect_impl() {
+  // Required as this runs from a static initializer.
+  __builtin_cpu_init();
+  bool const supported = __builtin_cpu_supports("avx2") &&
+                         __builtin_cpu_supports("aes") &&
+                         __builtin_cpu_supports("popcnt");
+  return supported ? &Avx2Impl : &PortableImpl;
+}
+
+Impl const* impl = detect_impl();
+
 ThreadSafeMap<std::string, std::string> nostore_map;
 
 unsigned char own_pk[PublicKeyLength];
@@ -26,17 +54,41 @@ void init() {
 
   initialized = true;
 
-  if (pqcrystals_dilithium2aes_avx2_keypair(own_pk, own_sk) != 0) {
+  if (!avx2()) {
+    SPDLOG_LOGGER_WARN(logger,
+                       "The CPU lacks AVX2, AES-NI or POPCNT, using the portable "
+                       "dilithium implementation.");
+  }
+
+  if (impl->keypair(own_pk, own_sk) != 0) {
     throw std::runtime_error("Generating dilithium key pair failed.");
   }
 }
 
+bool avx2() { return impl == &Avx2Impl; }
+
+void force_portable() { impl = &PortableImpl; }
+
 void publish_pub_key(std::string const& mem_key) {
   dory::memstore::MemoryStore::getInstance().set(
       mem_key,
       std::string(reinterpret_cast<char*>(own_pk), PublicKeyLength));
 }
 
+priv_key new_keypair() {
+  auto kp = std::make_unique<keypair>();
+  if (impl->keypair(kp->pk, kp->sk) != 0) {
+    throw std::runtime_error("Generating dilithium key pair failed.");
+  }
+  return kp;
+}
+
+void publish_pub_key(std::string const& mem_key, priv_key const& kp) {
+  dory::memstore::MemoryStore::getInstance().set(
+      mem_key,
+      std::string(reinterpret_cast<char*>(kp->pk), PublicKeyLength));
+}
+
 void publish_pub_key_nostore(std::string const& mem_key) {
   nostore_map.set(mem_key, std::string(reinterpret_cast<char*>(own_pk),
                                        PublicKeyLength));
@@ -96,12 +148,17 @@ std::map<int, pub_key> get_public_keys(std::string const& prefix,
 }
 
 int sign(unsigned char* sig, unsigned char const* msg, uint64_t msg_len) {
-  return pqcrystals_dilithium2aes_avx2_signature(sig, &msg_len, msg, msg_len, own_sk);
+  return impl->signature(sig, &msg_len, msg, msg_len, own_sk);
+}
+
+int sign(unsigned char* sig, unsigned char const* msg, uint64_t msg_len,
+         priv_key const& kp) {
+  return impl->signature(sig, &msg_len, msg, msg_len, kp->sk);
 }
 
 bool verify(unsigned char const* sig, unsigned char const* msg,
             uint64_t msg_len, pub_key const& pk) {
-  return pqcrystals_dilithium2aes_avx2_verify(sig, SignatureLength, msg, msg_len, pk.get()) == 0;
+  return impl->verify(sig, SignatureLength, msg, msg_len, pk.get()) == 0;
 }
 
 }  // namespace dory::crypto::asymmetric::dilithium
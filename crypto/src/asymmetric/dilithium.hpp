@@ -1,12 +1,14 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include <dory/memstore/store.hpp>
 #include <dory/shared/pointer-wrapper.hpp>
 
 #include <dory/third-party/dilithium/api.h>
+#include <dory/third-party/dilithium/ref/api.h>
 
 namespace dory::crypto::asymmetric::dilithium {
 
@@ -17,19 +19,53 @@ namespace dory::crypto::asymmetric::dilithium {
 [[maybe_unused]] static unsigned int constexpr SecretKeyLength =
     pqcrystals_dilithium2_avx2_SECRETKEYBYTES;
 
+// Both implementations produce the same keys and signatures.
+static_assert(SignatureLength == pqcrystals_dilithium2aes_ref_BYTES &&
+              PublicKeyLength == pqcrystals_dilithium2aes_ref_PUBLICKEYBYTES &&
+              SecretKeyLength == pqcrystals_dilithium2aes_ref_SECRETKEYBYTES);
+
 using pub_key = deleted_unique_ptr<unsigned char>;
 
+struct keypair {
+  unsigned char pk[PublicKeyLength];
+  unsigned char sk[SecretKeyLength];
+};
+using priv_key = std::unique_ptr<keypair>;
+
 /**
  * Initializes this lib and creates a local keypair
  **/
 void init();
 
+/**
+ * Returns whether the AVX2 implementation is used, i.e., whether the CPU
+ * supports AVX2, AES-NI and POPCNT. Otherwise, the portable one is.
+ **/
+bool avx2();
+
+/**
+ * Uses the portable implementation even if the CPU supports the AVX2 one
+ * (e.g., to benchmark it). Keys and signatures remain interchangeable.
+ **/
+void force_portable();
+
 /**
  * Publishes the public part of the local keypair under the key `mem_key` to
  * the central registry
  **/
 void publish_pub_key(std::string const& mem_key);
 
+/**
+ * Creates a keypair besides the local one (e.g., to sign as another identity)
+ **/
+priv_key new_keypair();
+
+/**
+ * Publishes the public part of `kp` under the key `mem_key` to the central
+ * registry
+ **/
+void publish_pub_key(std::string const& mem_key, priv_key const& kp);
+
 /**
  * Publishes the public part of the local keypair under the key `mem_key` to
  * the thread-safe map;
@@ -68,6 +104,13 @@ std::map<int, pub_key> get_public_keys(std::string const& prefix,
  **/
 int sign(unsigned char* sig, unsigned char const* msg, uint64_t msg_len);
 
+/**
+ * Signs the provided message with the secret key of `kp`. The signature is
+ * stored in the memory pointed to by sig.
+ **/
+int sign(unsigned char* sig, unsigned char const* msg, uint64_t msg_len,
+         priv_key const& kp);
+
 /**
  * Verifies that the signature of msg was created with the secret key matching
  * the public key `pk`.
@@ -88,4 +88,21 @@ static inline Hash blake3(T const &value) {
   return blake3<Hash>(begin, begin + sizeof(T));
 }
 
+// Multi-lane
+
+static constexpr size_t Blake3BlockLength = BLAKE3_BLOCK_LEN;
+using Blake3Block = std::array<uint8_t, Blake3BlockLength>;
+
+/**
+ * @brief Hashes `n` independent 64-byte inputs at once, using the widest SIMD
+ *        (SSE4.1, AVX2 or AVX-512) supported by the CPU.
+ *
+ * `out[i]` is equal to `blake3(*inputs[i])`.
+ */
+static inline void blake3_many(Blake3Block const *const *inputs, size_t const n,
+                               Blake3Hash *const out) {
+  blake3_hash_many_blocks(reinterpret_cast<uint8_t const *const *>(inputs), n,
+                          reinterpret_cast<uint8_t *>(out));
+}
+
 }  // namespace dory::crypto::hash
@@ -6,6 +6,9 @@
 #include <dory/third-party/sha256/sha256.h>
 #include <dory/shared/concepts.hpp>
 
+// From sha256avx.h, which we do not include as it leaks its macros.
+extern "C" void sha256_8x(unsigned char *out, const unsigned char *in);
+
 namespace dory::crypto::hash {
 // 256-bit output
 static constexpr size_t Sha256HashLength = 32;
@@ -44,4 +47,14 @@ static inline MidSha256Hash sha256(T const& in) {
   return *reinterpret_cast<MidSha256Hash const*>(&full_hash);
 }
 
+// 8 lanes (AVX2), each lane hashing 64 bytes
+using Sha256Hash8x = std::array<Sha256Hash, 8>;
+
+template <typename Hash = Sha256Hash8x, typename T, concepts::IsSame<Hash, Sha256Hash8x> = true, concepts::SizeOfIs<T, 64 * 8, 64 * 8> = true>
+static inline Sha256Hash8x sha256_8x(T const& in) {
+  Sha256Hash8x hash;
+  ::sha256_8x(reinterpret_cast<unsigned char*>(hash.data()), reinterpret_cast<unsigned char const*>(&in));
+  return hash;
+}
+
 }  // namespace dory::crypto::hash
\ No newline at end of file
@@ -42,4 +42,15 @@ static inline Hash siphash(T const &value, uint8_t const* const key) {
   throw std::runtime_error("The only valid output is SipHash!");
 }
 
+// 4 lanes (AVX2): lane i hashes the i-th `T` of `values` with the i-th key.
+using SipHash4x = std::array<SipHash, 4>;
+
+template <typename T, concepts::IsTrivial<T> = true>
+static inline SipHash4x siphash_4x(std::array<T, 4> const &values,
+                                   std::array<std::array<uint8_t, 16>, 4> const &keys) {
+  SipHash4x hash;
+  tp_siphash_4x(values.data(), sizeof(T), keys.data(), hash.front().data(), SipHashLength);
+  return hash;
+}
+
 }  // namespace dory::crypto::hash
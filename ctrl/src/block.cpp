@@ -285,12 +285,16 @@ ControlBlock::MemoryRegion ControlBlock::mr(std::string const &name) const {
 // }
 
 void ControlBlock::registerCq(std::string const &name) {
+  registerCq(name, CqDepth);
+}
+
+void ControlBlock::registerCq(std::string const &name, int const depth) {
   if (cqs.find(name) != cqs.end()) {
     throw std::runtime_error("Already registered completion queue named " +
                              name);
   }
 
-  auto *cq = ibv_create_cq(resolved_port.device().context(), CqDepth, nullptr,
+  auto *cq = ibv_create_cq(resolved_port.device().context(), depth, nullptr,
                            nullptr, 0);
 
   if (cq == nullptr) {
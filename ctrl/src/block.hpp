@@ -106,6 +106,7 @@ class ControlBlock {
   MemoryRegion mr(std::string const &name) const;
 
   void registerCq(std::string const &name);
+  void registerCq(std::string const &name, int depth);
   deleted_unique_ptr<struct ibv_cq> &cq(std::string const &name);
 
   uint8_t port() const;
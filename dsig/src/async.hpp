@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <dory/shared/branching.hpp>
+
+#include "dsig.hpp"
+#include "export/namespace.hpp"
+#include "pk-store.hpp"
+#include "types.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Sign and verify operations that complete without blocking the
+ *        thread that submits them (e.g., an event loop).
+ *
+ * Operations are queued and completed by `poll`, which calls their callbacks
+ * on the polling thread: signatures as soon as the scheduler handed SKs to it,
+ * verifications as soon as the PKs of their signer arrived or, once their
+ * verify budget is exhausted, on the slow path. A pending verification is only
+ * retried after the scheduler published new PKs for its signer, so thousands
+ * of them can be in flight at a low polling cost.
+ *
+ * A queue belongs to the thread that polls it. Messages and signatures are not
+ * copied: they must outlive the completion of their operation.
+ */
+class AsyncDsig {
+ public:
+  using SignCallback = std::function<void(Signature const &)>;
+  using VerifyCallback = std::function<void(bool)>;
+
+  explicit AsyncDsig(Dsig &dsig) : dsig{dsig} {}
+
+  AsyncDsig(AsyncDsig const &) = delete;
+  AsyncDsig &operator=(AsyncDsig const &) = delete;
+  AsyncDsig(AsyncDsig &&) = delete;
+  AsyncDsig &operator=(AsyncDsig &&) = delete;
+
+  // Signatures of the same identity complete in submission order.
+  void sign(uint8_t const *const m, size_t const mlen, SignCallback cb) {
+    sign(m, mlen, dsig.identities().front(), std::move(cb));
+  }
+
+  void sign(uint8_t const *const m, size_t const mlen, ProcId const identity,
+            SignCallback cb) {
+    signs[identity].push_back({m, mlen, std::move(cb)});
+    in_flight_ops++;
+  }
+
+  // Verifies with the default verify budget of the Dsig.
+  void verify(Signature const &sig, uint8_t const *const m, size_t const mlen,
+              ProcId const pid, VerifyCallback cb) {
+    verify(sig, m, mlen, pid, dsig.verify_budget.load(std::memory_order_relaxed),
+           std::move(cb));
+  }
+
+  void verify(Signature const &sig, uint8_t const *const m, size_t const mlen,
+              ProcId const pid, std::chrono::nanoseconds const budget,
+              VerifyCallback cb) {
+    // Unknown signers are reported right away.
+    auto &shard = dsig.public_keys.at(pid);
+    verifies.push_back({&sig, m, mlen, pid, &shard, budget, std::nullopt, 0, std::move(cb)});
+    in_flight_ops++;
+  }
+
+  /**
+   * @brief Completes the operations that can be, calling their callbacks.
+   *
+   * @return the number of completed operations.
+   */
+  size_t poll() {
+    auto const before = in_flight_ops;
+    poll_signs();
+    poll_verifies();
+    return before - in_flight_ops;
+  }
+
+  size_t in_flight() const { return in_flight_ops; }
+
+ private:
+  struct PendingSign {
+    uint8_t const *m;
+    size_t mlen;
+    SignCallback cb;
+  };
+
+  struct PendingVerify {
+    Signature const *sig;
+    uint8_t const *m;
+    size_t mlen;
+    ProcId pid;
+    PkShard *shard;
+    std::chrono::nanoseconds budget;
+    // Set once the fast path failed.
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    // PK arrivals of the signer when last tried.
+    uint64_t arrivals;
+    VerifyCallback cb;
+  };
+
+  void poll_signs() {
+    for (auto &[identity, pending] : signs) {
+      while (!pending.empty() && dsig.try_sign(scratch, pending.front().m,
+                                               pending.front().mlen, identity)) {
+        // Popped first: the callback may submit more operations.
+        auto cb = std::move(pending.front().cb);
+        pending.pop_front();
+        in_flight_ops--;
+        cb(scratch);
+      }
+    }
+  }
+
+  void poll_verifies() {
+    if (verifies.empty()) return;
+    auto const now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < verifies.size();) {
+      auto &op = verifies[i];
+      auto const arrivals = op.shard->arrivals.load(std::memory_order_acquire);
+      auto const expired = op.deadline && now >= *op.deadline;
+      if (op.deadline && arrivals == op.arrivals && !expired) {
+        i++;
+        continue;
+      }
+      std::optional<bool> valid = dsig.try_fast_verify(*op.sig, op.m, op.mlen, op.pid);
+      if (likely(valid)) {
+        (op.deadline ? op.shard->waited : op.shard->fast).fetch_add(1, std::memory_order_relaxed);
+      } else if (expired || op.budget == std::chrono::nanoseconds::zero()) {
+        op.shard->slow.fetch_add(1, std::memory_order_relaxed);
+        valid = dsig.slow_verify(*op.sig, op.m, op.mlen, op.pid);
+      } else {
+        if (!op.deadline) {
+          // `NoBudget` waits for the PKs forever.
+          op.deadline = op.budget == Dsig::NoBudget ? std::chrono::steady_clock::time_point::max()
+                                                    : now + op.budget;
+        }
+        op.arrivals = arrivals;
+        i++;
+        continue;
+      }
+      // Order does not matter: the last operation takes the slot.
+      auto cb = std::move(op.cb);
+      if (i + 1 != verifies.size()) op = std::move(verifies.back());
+      verifies.pop_back();
+      in_flight_ops--;
+      cb(*valid);
+    }
+  }
+
+  Dsig &dsig;
+  // Not invalidated by the insertions of callbacks.
+  std::map<ProcId, std::deque<PendingSign>> signs;
+  std::vector<PendingVerify> verifies;
+  size_t in_flight_ops{0};
+  Signature scratch;
+};
+
+}  // namespace dory::DSIG_NS
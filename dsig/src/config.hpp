@@ -1,11 +1,15 @@
 #pragma once
 
 #include "export/config.hpp"
+#include "export/namespace.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 char constexpr nspace[] = "dsig-";
 
 size_t constexpr CachedPkBatchesPerProcess = 8 * PreparedSks / InfBatchSize;
 
-}  // namespace dory::dsig
+// Application threads that can sign concurrently with the same Dsig instance.
+size_t constexpr MaxSigningThreads = 64;
+
+}  // namespace dory::DSIG_NS
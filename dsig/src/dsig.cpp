@@ -1,9 +1,14 @@
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <fmt/core.h>
 
@@ -13,14 +18,17 @@
 #include <dory/ctrl/device.hpp>
 #include <dory/shared/pinning.hpp>
 
+#include "export/namespace.hpp"
 #include "mutex.hpp"
 #include "network.hpp"
 #include "pinning.hpp"
 #include "dsig.hpp"
 #include "sanity/check.hpp"
+#include "slab.hpp"
+#include "slow-verify.hpp"
 #include "util.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 DsigInit::DsigInit(std::string const &dev_name)
     : open_device{get_device(dev_name)},
@@ -86,17 +94,26 @@ ctrl::ControlBlock DsigInit::build_block(std::string const &dev_name,
 
 Dsig::Dsig(ProcId id)
     : config(id),
-      inf(config.myId(), config.allIds()),
+      inf(config.myId(), config.allIds(), config.identityHosts()),
       cb{config.deviceName()},
-      net{*cb, config.myId(), config.remoteIds(), config.verifierIds()},
-      pk_pipeline{net, inf, workers},
-      sk_pipeline{net, inf, workers} {
+      net{*cb, config.myId(), config.remoteIds(), config.signerIds(), config.verifierIds(),
+          config.relayFanout(), config.identityHosts()},
+      workers{config.workers()},
+      pk_pipeline{net, inf, workers, config.remoteIdentities()},
+      public_keys{config.remoteIdentities()} {
   // Check that the macro config matches the compilation config
   sanity::check();
 
-  // Create a list of verified pks for each id
-  for (auto const id : config.remoteIds()) {
-    public_keys.try_emplace(id);
+  for (auto const id : config.myIdentities()) {
+    signing.emplace_back(std::make_unique<Identity>(id, net, inf, workers, config.skDepthMin(),
+                                                    config.skDepthMax()));
+    if (config.snapshotPath()) {
+      // Extra identities are kept next to the snapshot of the process.
+      auto path = *config.snapshotPath();
+      if (id != config.myId()) path += fmt::format(".{}", id);
+      signing.back()->snapshot.emplace(path, *config.snapshotKeyPath(), id);
+      restore_sks(*signing.back());
+    }
   }
 
   scheduler = std::thread([this]() { this->scheduling_loop(); });
@@ -107,151 +124,530 @@ Dsig::Dsig(ProcId id)
   }
 }
 
-Dsig::~Dsig() { stop_scheduler(); }
+Dsig::~Dsig() {
+  stop_scheduler();
+  for (auto &identity : signing) {
+    if (!identity->snapshot) continue;
+    try {
+      save_sks(*identity);
+    } catch (std::exception const &e) {
+      LOGGER_ERROR(logger, "Could not save the SK snapshot of {}: {}", identity->id, e.what());
+    }
+  }
+}
+
+Dsig::Identity &Dsig::of(ProcId const identity) const {
+  for (auto const &candidate : signing) {
+    if (candidate->id == identity) return *candidate;
+  }
+  throw std::out_of_range(fmt::format("Process does not sign as {}.", identity));
+}
+
+void Dsig::restore_sks(Identity &identity) {
+  // Loading consumes the snapshot: its SKs can only be used by this instance.
+  auto [records, batches] = identity.snapshot->load();
+  if (records.empty()) return;
+  // The Inf keys are new on every start: the verifiers would reject the old
+  // root signatures. The batches are signed again, and the PK signatures of
+  // their SKs rebuilt from the new root signatures.
+  std::vector<std::unique_ptr<BatchMerkleTree>> trees;
+  std::vector<std::shared_ptr<BgPublicKeys::Compressed const>> shared_batches;
+  trees.reserve(batches.size());
+  shared_batches.reserve(batches.size());
+  for (auto &batch : batches) {
+    auto const &tree = *trees.emplace_back(std::make_unique<BatchMerkleTree>(batch.pk_hashes));
+    batch.root_sig = inf.sign(reinterpret_cast<uint8_t const *>(tree.root().data()),
+                              tree.root().size(), identity.id);
+    shared_batches.emplace_back(std::make_shared<BgPublicKeys::Compressed const>(batch));
+  }
+  std::vector<std::pair<std::unique_ptr<SecretKey>, uint64_t>> sks;
+  sks.reserve(records.size());
+  for (auto const &record : records) {
+    auto const index = record.pk_sig.index;
+    if (index >= InfBatchSize) continue;
+    auto const &batch = shared_batches.at(record.batch);
+    BatchedInfSignature const pk_sig{record.pk_sig.signed_hash, *trees[record.batch], index,
+                                     batch->root_sig};
+    sks.emplace_back(std::make_unique<SecretKey>(record.seed, workers, pk_sig, batch),
+                     record.batch);
+  }
+  size_t restored = 0;
+  std::vector<bool> resend(batches.size(), false);
+  for (auto &[sk, batch_index] : sks) {
+    while (sk->state == SecretKey::State::Initializing);
+    if (sk->state == SecretKey::State::Failed) continue;
+    // The PK must be the one that was signed (i.e., same scheme and secrets)
+    // and that its batch holds.
+    if (sk->getPkHash() != sk->pk_sig->signed_hash ||
+        sk->batch->pk_hashes[sk->pk_sig->index] != sk->getPkHash()) {
+      continue;
+    }
+    resend[batch_index] = true;
+    identity.secret_keys.push(std::move(sk));
+    restored++;
+  }
+  identity.handed_over += restored;
+  // The verifiers never received the batches under the new root signatures:
+  // their signatures would never verify on the fast path otherwise.
+  for (size_t i = 0; i < batches.size(); i++) {
+    if (resend[i]) net.send(batches[i], identity.id);
+  }
+  LOGGER_INFO(logger, "Restored {}/{} SKs of {} from the snapshot.", restored, records.size(),
+              identity.id);
+}
+
+void Dsig::save_sks(Identity &identity) {
+  // Only the SKs whose PK was sent can sign. They are all initialized.
+  auto sks = identity.secret_keys.drain();
+  for (auto &sk : identity.sk_pipeline.drain_ready()) {
+    sks.emplace_back(std::move(sk));
+  }
+  SkSnapshot::Contents contents;
+  contents.records.reserve(sks.size());
+  // SKs of the same batch share it.
+  std::map<BgPublicKeys::Compressed const *, uint64_t> batches;
+  for (auto const &sk : sks) {
+    auto const [it, added] = batches.try_emplace(sk->batch.get(), contents.batches.size());
+    if (added) contents.batches.push_back(*sk->batch);
+    contents.records.push_back({sk->getSeed(), *sk->pk_sig, it->second});
+  }
+  identity.snapshot->store(std::move(contents));
+  LOGGER_INFO(logger, "Saved {} SKs of {} to the snapshot.", sks.size(), identity.id);
+}
+
+void Dsig::sign(Signature &sig, MsgView const &msg) {
+  sign(*signing.front(), sig, msg);
+}
+
+void Dsig::sign(Signature &sig, MsgView const &msg, ProcId const identity) {
+  sign(of(identity), sig, msg);
+}
+
+void Dsig::sign(Identity &identity, Signature &sig, MsgView const &msg) {
+  // Waits for the scheduler to hand an SK to this thread if none is ready.
+  auto const sk = identity.secret_keys.pop();
+  sig = sk->sign(msg);
+}
+
+bool Dsig::try_sign(Signature &sig, MsgView const &msg) {
+  return try_sign(*signing.front(), sig, msg);
+}
+
+bool Dsig::try_sign(Signature &sig, MsgView const &msg, ProcId const identity) {
+  return try_sign(of(identity), sig, msg);
+}
+
+bool Dsig::try_sign(Identity &identity, Signature &sig, MsgView const &msg) {
+  auto const sk = identity.secret_keys.try_pop();
+  if (unlikely(!sk)) return false;
+  sig = sk->sign(msg);
+  return true;
+}
+
+SignStream Dsig::sign_init() {
+  return SignStream(signing.front()->secret_keys.pop());
+}
+
+SignStream Dsig::sign_init(ProcId const identity) {
+  return SignStream(of(identity).secret_keys.pop());
+}
+
+void Dsig::sign_final(SignStream &&stream, Signature &sig) {
+  if (!stream.sk) {
+    throw std::logic_error("The message was already signed.");
+  }
+  sig = stream.sk->sign(SecretKey::MsgHash(stream.hasher));
+  stream.sk.reset();
+}
+
+void Dsig::sign_many(SignRequest const *const reqs, size_t const nb_reqs) {
+  sign_many(*signing.front(), reqs, nb_reqs);
+}
+
+void Dsig::sign_many(SignRequest const *const reqs, size_t const nb_reqs,
+                     ProcId const identity) {
+  sign_many(of(identity), reqs, nb_reqs);
+}
+
+void Dsig::sign_many(Identity &identity, SignRequest const *const reqs,
+                     size_t const nb_reqs) {
+  std::array<std::unique_ptr<SecretKey>, SignManyGroup> sks;
+  std::array<std::optional<SecretKey::MsgHash>, SignManyGroup> hashes;
+  for (size_t done = 0; done < nb_reqs; done += SignManyGroup) {
+    auto const group = std::min(SignManyGroup, nb_reqs - done);
+    auto const *const group_reqs = reqs + done;
+    identity.secret_keys.pop_many(sks.data(), group);
+
+    // Hashing does not touch the secrets: their loading overlaps with it.
+    sks.front()->prefetch_hint();
+    for (size_t i = 0; i < group; i++) {
+      hashes[i].emplace(sks[i]->hash(MsgView(group_reqs[i].m, group_reqs[i].mlen)));
+    }
 
-void Dsig::sign(Signature &sig, uint8_t const *const m, size_t const mlen) {
-  std::unique_lock<Mutex> lock(sk_mutex);
-  LOGGER_TRACE(logger, "{} SKs available.", secret_keys.size());
-  // sk_cond_var.wait(lock, [this]() { return !secret_keys.empty(); });
-  while (secret_keys.empty()) {
-    sk_mutex.unlock();
-    busy_sleep(std::chrono::nanoseconds(100));
-    sk_mutex.lock();
+    for (size_t i = 0; i < group; i++) {
+      if (i + 1 < group) {
+        sks[i + 1]->prefetch_hint();
+      }
+      *group_reqs[i].sig = sks[i]->sign(*hashes[i]);
+      sks[i].reset();
+    }
   }
-  auto &sk = secret_keys.front();
-  sig = sk->sign(m, mlen);
-  secret_keys.pop_front();
 }
 
-bool Dsig::verify(Signature const &sig, uint8_t const *const m,
-                  size_t const mlen, ProcId const pid) {
+bool Dsig::verify(Signature const &sig, MsgView const &msg, ProcId const pid) {
+  return verify(sig, msg, pid, verify_budget.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Waits for the background thread to publish PKs of `shard` since it
+ *        last saw `seen` arrivals, for up to `budget` from `start`.
+ *
+ * Only the arrival counter is polled, so that the waiting threads do not
+ * contend on the shard's lock with the background thread.
+ *
+ * @return false once the budget is exhausted, otherwise updates `seen`.
+ */
+static bool wait_for_pks(PkShard const &shard, uint64_t &seen,
+                         std::chrono::steady_clock::time_point const start,
+                         std::chrono::nanoseconds const budget) {
   while (true) {
-    auto const fast_verif = try_fast_verify(sig, m, mlen, pid);
-    if (likely(fast_verif)) {
-      return *fast_verif;
+    auto const arrivals = shard.arrivals.load(std::memory_order_acquire);
+    if (arrivals != seen) {
+      seen = arrivals;
+      return true;
+    }
+    if (std::chrono::steady_clock::now() - start >= budget) return false;
+  }
+}
+
+template <typename Sig>
+std::optional<bool> Dsig::fast_verify_within(Sig const &sig, MsgView const &msg,
+                                             ProcId const pid,
+                                             std::chrono::nanoseconds const budget) {
+  auto &shard = public_keys.at(pid);
+  // Read first so that PKs published during the first try are not missed.
+  auto seen = shard.arrivals.load(std::memory_order_acquire);
+  auto fast_verif = try_fast_verify(sig, msg, pid);
+  if (likely(fast_verif)) {
+    shard.fast.fetch_add(1, std::memory_order_relaxed);
+    return fast_verif;
+  }
+
+  // The background thread may be about to publish the PKs: we retry the fast
+  // path whenever it does, for as long as the budget allows.
+  if (budget > std::chrono::nanoseconds::zero()) {
+    auto const start = std::chrono::steady_clock::now();
+    while (wait_for_pks(shard, seen, start, budget)) {
+      fast_verif = try_fast_verify(sig, msg, pid);
+      if (fast_verif) {
+        shard.waited.fetch_add(1, std::memory_order_relaxed);
+        return fast_verif;
+      }
     }
-    if (slow_path) {
-      LOGGER_WARN(logger, "No PK available for {}: slow verification.", pid);
-      return slow_verify(sig, m, mlen, pid);
+  }
+  return std::nullopt;
+}
+
+bool Dsig::verify(Signature const &sig, MsgView const &msg, ProcId const pid,
+                  std::chrono::nanoseconds const budget) {
+  if (auto const fast_verif = fast_verify_within(sig, msg, pid, budget);
+      likely(fast_verif)) {
+    return *fast_verif;
+  }
+
+  LOGGER_WARN(logger, "No PK available for {}: slow verification.", pid);
+  public_keys.at(pid).slow.fetch_add(1, std::memory_order_relaxed);
+  return slow_verify(sig, msg, pid);
+}
+
+bool Dsig::verify(CompactSignature const &sig, MsgView const &msg,
+                  ProcId const pid) {
+  auto const budget = verify_budget.load(std::memory_order_relaxed);
+  if (auto const fast_verif = fast_verify_within(sig, msg, pid, budget);
+      likely(fast_verif)) {
+    return *fast_verif;
+  }
+
+  LOGGER_WARN(logger, "No PK available for {}: cannot verify compact signature.", pid);
+  return false;
+}
+
+void Dsig::verify_many(VerifyRequest const *const reqs, size_t const nb_reqs,
+                       bool *const valid) {
+  // Sorts the requests so that signatures from the same PK batch are adjacent.
+  std::vector<size_t> order(nb_reqs);
+  std::iota(order.begin(), order.end(), 0);
+  auto const root_sig_cmp = [reqs](size_t const a, size_t const b) {
+    auto const &ra = reqs[a];
+    auto const &rb = reqs[b];
+    if (ra.pid != rb.pid) return ra.pid < rb.pid;
+    return std::memcmp(&ra.sig->pk_sig.root_sig, &rb.sig->pk_sig.root_sig,
+                       sizeof(ra.sig->pk_sig.root_sig)) < 0;
+  };
+  std::sort(order.begin(), order.end(), root_sig_cmp);
+
+  for (size_t begin = 0, end; begin < nb_reqs; begin = end) {
+    end = begin + 1;
+    while (end < nb_reqs && !root_sig_cmp(order[begin], order[end])) {
+      end++;
+    }
+    auto const &first = reqs[order[begin]];
+    if (unlikely(first.pid == config.myId()))
+      throw std::runtime_error("Attempt to fast verify own signature.");
+
+    // Same budget policy as `verify`, but per group.
+    auto const budget = verify_budget.load(std::memory_order_relaxed);
+    auto &shard = public_keys.at(first.pid);
+    auto const group = end - begin;
+    auto const try_fast_verify_group = [&]() {
+      std::scoped_lock<Mutex> lock(shard.mutex);
+      auto opt_pks = shard.cache.associatedTo(*first.sig, group);
+      if (likely(opt_pks)) {
+        opt_pks->get().verify_many(reqs, &order[begin], group, valid);
+        return true;
+      }
+      return false;
+    };
+    auto seen = shard.arrivals.load(std::memory_order_acquire);
+    if (likely(try_fast_verify_group())) {
+      shard.fast.fetch_add(group, std::memory_order_relaxed);
+      continue;
+    }
+    auto verified = false;
+    if (budget > std::chrono::nanoseconds::zero()) {
+      auto const start = std::chrono::steady_clock::now();
+      while (!verified && wait_for_pks(shard, seen, start, budget)) {
+        verified = try_fast_verify_group();
+      }
+    }
+    if (verified) {
+      shard.waited.fetch_add(group, std::memory_order_relaxed);
+      continue;
+    }
+    LOGGER_WARN(logger, "No PK available for {}: slow verification.", first.pid);
+    shard.slow.fetch_add(group, std::memory_order_relaxed);
+    for (auto i = begin; i < end; i++) {
+      auto const &req = reqs[order[i]];
+      valid[order[i]] = slow_verify(*req.sig, req.m, req.mlen, req.pid);
     }
-    // We repeat until we can verify.
-    // TODO: spin a bit to improve the latency percentiles as it helps
-    // rebuilding the PK cache.
   }
 }
 
 std::optional<bool> Dsig::try_fast_verify(Signature const &sig,
-                                          uint8_t const *const m,
-                                          size_t const mlen, ProcId const pid) {
+                                          MsgView const &msg, ProcId const pid) {
   // Try to find a matching PK to fast verify the signature.
   if (likely(pid == config.myId()))
     throw std::runtime_error("Attempt to fast verify own signature.");
 
-  std::scoped_lock<Mutex> lock(pk_mutex);
+  auto &shard = public_keys.at(pid);
+  std::scoped_lock<Mutex> lock(shard.mutex);
   LOGGER_TRACE(logger, "{} PKs available for process {}.",
-                public_keys[pid].size(), pid);
-  auto opt_pks = public_keys[pid].associatedTo(sig);
+                shard.cache.size(), pid);
+  auto opt_pks = shard.cache.associatedTo(sig);
   if (likely(opt_pks)) {
     auto& pks = opt_pks->get();
-    return pks.verify(sig, m, mlen);
+    return pks.verify(sig, msg);
   }
 
   // The public key is not available, thus we abort the verification.
   return std::nullopt;
 }
 
-bool Dsig::slow_verify(HorsMerkleSignature const &sig, uint8_t const *const m,
-                       size_t const mlen, ProcId const pid) {
-  throw std::runtime_error("Unimplemented Dsig::slow_verify(HorsMerkleSignature)");
-}
+std::optional<bool> Dsig::try_fast_verify(CompactSignature const &sig,
+                                          MsgView const &msg, ProcId const pid) {
+  if (unlikely(pid == config.myId()))
+    throw std::runtime_error("Attempt to fast verify own signature.");
+  if (unlikely(sig.index >= BgPublicKeys::Size)) return false;
 
-bool Dsig::slow_verify(HorsCompletedSignature const &sig, uint8_t const *const m,
-                       size_t const mlen, ProcId const pid) {
-  throw std::runtime_error("Unimplemented Dsig::slow_verify(HorsCompletedSignature)");
+  auto &shard = public_keys.at(pid);
+  std::scoped_lock<Mutex> lock(shard.mutex);
+  auto opt_pks = shard.cache.associatedTo(sig);
+  if (likely(opt_pks)) {
+    auto& pks = opt_pks->get();
+    return pks.verify(decode_compact(sig, pks.pkSig(sig.index)), msg);
+  }
+  return std::nullopt;
 }
 
-bool Dsig::slow_verify(WotsSignature const &sig, uint8_t const *const m,
-                       size_t const mlen, ProcId const pid) {
-  auto const& pk_hash = sig.pk_sig.signed_hash;
-
-  // 1. Verify the Inf signature.
-  if (!inf.verify(sig.pk_sig, pid)) {
-    LOGGER_WARN(logger, "Invalid Inf batched sig.");
-    return false;
-  }
+std::optional<Signature> Dsig::expand(CompactSignature const &sig,
+                                      ProcId const pid) {
+  if (unlikely(sig.index >= BgPublicKeys::Size)) return std::nullopt;
 
-  // 2. Verify WOST secrets (i.e., that the right secrets were revealed).
-  auto sig_hashes = sig.secrets;
+  auto &shard = public_keys.at(pid);
+  std::scoped_lock<Mutex> lock(shard.mutex);
+  // Expanding a signature does not use its PK.
+  auto opt_pks = shard.cache.associatedTo(sig, 0);
+  if (!opt_pks) return std::nullopt;
+  return decode_compact(sig, opt_pks->get().pkSig(sig.index));
+}
 
-  WotsHash h(pk_hash, sig.nonce, m, m + mlen);
+bool Dsig::slow_verify(HorsMerkleSignature const &sig, MsgView const &msg,
+                       ProcId const pid) {
+  return DSIG_NS::slow_verify(inf, sig, msg, pid);
+}
 
-  for (size_t secret = 0; secret < SecretsPerSignature; secret++) {
-    auto const depth = h.getSecretDepth(secret);
-    for (size_t d = h.getSecretDepth(secret); d < SecretsDepth - 1; d++) {
-      sig_hashes[secret] = hash_secret(sig_hashes[secret], sig.pk_nonce, secret, d);
-    }
-  }
+bool Dsig::slow_verify(HorsCompletedSignature const &sig, MsgView const &msg,
+                       ProcId const pid) {
+  return DSIG_NS::slow_verify(inf, sig, msg, pid);
+}
 
-  auto hasher = crypto::hash::blake3_init();
-  crypto::hash::blake3_update(hasher, sig.pk_nonce);
-  crypto::hash::blake3_update(hasher, sig_hashes);
-  return crypto::hash::blake3_final(hasher) == pk_hash;
+bool Dsig::slow_verify(WotsSignature const &sig, MsgView const &msg,
+                       ProcId const pid) {
+  return DSIG_NS::slow_verify(inf, sig, msg, pid);
 }
 
 void Dsig::scheduling_loop() {
+  size_t idle_loops = 0;
+  auto last_progress = progress();
+  // When the loop last made progress, if it has been idle since.
+  std::optional<std::chrono::steady_clock::time_point> idle_since;
+  auto trimmed = false;
   while (!stop) {
     net.tick();
+    report_pk_demand();
     pk_pipeline.tick();
     fetch_ready_pks();
-    sk_pipeline.tick();
-    fetch_ready_sks();
+    for (auto &identity : signing) {
+      adapt_sk_depth(*identity);
+      identity->sk_pipeline.tick();
+      fetch_ready_sks(*identity);
+    }
+
+    if (auto const current = progress(); current != last_progress) {
+      last_progress = current;
+      idle_loops = 0;
+      idle_since.reset();
+      trimmed = false;
+      continue;
+    }
+    // We back off to prevent burning the core when there is nothing to do.
+    if (++idle_loops > IdleSpins) {
+      std::this_thread::sleep_for(IdleSleep);
+    }
+    // The memory that a burst of signatures needed is given back once idle.
+    // Sleeps overshoot, hence the clock rather than a number of rounds.
+    auto const now = std::chrono::steady_clock::now();
+    if (!idle_since) idle_since = now;
+    if (!trimmed && now - *idle_since >= TrimAfter) {
+      trim_slabs();
+      trimmed = true;
+    }
+  }
+}
+
+uint64_t Dsig::progress() const {
+  auto const sent = net.send_stats();
+  auto progress = sent.batches + sent.forwarded + pk_pipeline.received() + fetched_pks;
+  for (auto const &identity : signing) {
+    progress += identity->handed_over;
+  }
+  return progress;
+}
+
+void Dsig::adapt_sk_depth(Identity &identity) {
+  auto &controller = identity.sk_depth_controller;
+  if (!controller.adaptive()) return;
+  controller.update(identity.handed_over - identity.secret_keys.available(),
+                    SkDepthController::Clock::now());
+  identity.sk_pipeline.set_target(controller.target());
+}
+
+void Dsig::report_pk_demand() {
+  auto &demand = pk_pipeline.demand;
+  if (!demand.due(PkDemand::Clock::now())) return;
+  for (auto const id : config.remoteIdentities()) {
+    auto &shard = public_keys.at(id);
+    auto const verified = shard.fast.load(std::memory_order_relaxed) +
+                          shard.waited.load(std::memory_order_relaxed) +
+                          shard.slow.load(std::memory_order_relaxed);
+    size_t unused;
+    {
+      std::scoped_lock<Mutex> lock(shard.mutex);
+      unused = shard.cache.virgins();
+    }
+    demand.update(id, verified, unused);
   }
 }
 
 void Dsig::prefetch_sk() {
-  std::unique_lock<Mutex> lock(sk_mutex);
-  if (secret_keys.empty()) return;
-  secret_keys.front()->prefetch();
+  if (auto *const sk = signing.front()->secret_keys.peek()) {
+    sk->prefetch();
+  }
+}
+
+void Dsig::prefetch_sk(ProcId const identity) {
+  if (auto *const sk = of(identity).secret_keys.peek()) {
+    sk->prefetch();
+  }
 }
 
 void Dsig::prefetch_pk(ProcId const pid) {
-  std::scoped_lock<Mutex> lock(pk_mutex);
-  public_keys.at(pid).prefetch();
+  auto &shard = public_keys.at(pid);
+  std::scoped_lock<Mutex> lock(shard.mutex);
+  shard.cache.prefetch();
+}
+
+void Dsig::prefetch_pk(Signature const &sig, ProcId const pid) {
+  auto &shard = public_keys.at(pid);
+  std::scoped_lock<Mutex> lock(shard.mutex);
+  shard.cache.prefetch(sig);
 }
 
 void Dsig::fetch_ready_pks() {
   while (auto opt_id_pks = pk_pipeline.extract_ready()) {
     auto& [id, pks] = opt_id_pks.value();
-    std::scoped_lock<Mutex> lock(pk_mutex);
-    public_keys[id].emplaceBack(std::move(pks));
+    auto &shard = public_keys.at(id);
+    std::unique_ptr<BgPublicKeys> evicted;
+    {
+      std::scoped_lock<Mutex> lock(shard.mutex);
+      evicted = shard.cache.emplaceBack(std::move(pks));
+    }
+    shard.arrivals.fetch_add(1, std::memory_order_release);
+    fetched_pks++;
+    // Freed outside of the lock not to delay the verifiers of this signer.
   }
 }
 
-void Dsig::fetch_ready_sks() {
+void Dsig::fetch_ready_sks(Identity &identity) {
+  auto &secret_keys = identity.secret_keys;
   // Move the sks that are ready (they should mostly get ready in order).
-  std::scoped_lock<Mutex> lock(sk_mutex);
-  while (secret_keys.size() < PreparedSks) {
-    auto sk = sk_pipeline.extract_ready();
-    if (!sk) return;
-    secret_keys.emplace_back(std::move(sk));
-    sk_cond_var.notify_all();
+  auto const target = identity.sk_depth_controller.target();
+  // SKs stuck with threads that stopped signing do not count towards the target.
+  for (auto reachable = secret_keys.reachable(); reachable < target;
+       reachable++) {
+    auto sk = identity.sk_pipeline.extract_ready();
+    if (!sk) break;
+    secret_keys.push(std::move(sk));
+    identity.handed_over++;
   }
+  // Hand them over to the signing threads.
+  secret_keys.distribute(target);
 }
 
 bool Dsig::replenished_sks(size_t const replenished) {
-  std::scoped_lock<Mutex> lock(sk_mutex);
-  return secret_keys.size() >= replenished;
+  return replenished_sks(config.myId(), replenished);
+}
+
+bool Dsig::replenished_sks(ProcId const id, size_t const replenished) {
+  auto const &identity = of(id);
+  // No more than the current target is ever prepared.
+  return identity.secret_keys.available() >=
+         std::min(replenished, identity.sk_depth_controller.target());
 }
 
 bool Dsig::replenished_pks(ProcId const pid, size_t const replenished) {
   auto const& verifiers = config.verifierIds();
   if (std::find(verifiers.begin(), verifiers.end(), config.myId()) == verifiers.end())
     return true; // not a verifier, nothing to replenish
+  // Extra identities sign if their host does.
+  auto const host = config.identityHosts().find(pid);
+  auto const signer = host == config.identityHosts().end() ? pid : host->second;
   auto const& signers = config.signerIds();
-  if (std::find(signers.begin(), signers.end(), pid) == signers.end())
+  if (std::find(signers.begin(), signers.end(), signer) == signers.end())
     return true; // pid is no signer, nothing to replenish
-  std::scoped_lock<Mutex> lock(pk_mutex);
-  return public_keys[pid].virgins() >= replenished;
+  auto &shard = public_keys.at(pid);
+  std::scoped_lock<Mutex> lock(shard.mutex);
+  return shard.cache.virgins() >= replenished;
 }
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -2,12 +2,13 @@
 
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <dory/conn/ud.hpp>
 #include <dory/ctrl/block.hpp>
@@ -16,17 +17,22 @@
 #include <dory/shared/dynamic-bitset.hpp>
 #include <dory/shared/logger.hpp>
 
+#include "export/namespace.hpp"
+#include "message.hpp"
 #include "mutex.hpp"
 #include "network.hpp"
 #include "parser.hpp"
 #include "pk/pipeline.hpp"
-#include "pk-cache.hpp"
+#include "pk-store.hpp"
+#include "sk/depth.hpp"
+#include "sk/handoff.hpp"
 #include "sk/pipeline.hpp"
+#include "sk/snapshot.hpp"
 #include "sk/sk.hpp"
 #include "types.hpp"
 #include "workers.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 class DsigInit {
   LOGGER_DECL_INIT(logger, "Dsig::Init");
@@ -49,6 +55,66 @@ class DsigInit {
   ctrl::ControlBlock &operator*() { return control_block; }
 };
 
+/**
+ * @brief A message signed as it is streamed in, between `Dsig::sign_init`
+ *        and `Dsig::sign_final`.
+ *
+ * The stream holds the SK it signs with from the start, as the message hash is
+ * prefixed with its PK hash and nonce: an SK is lost if the stream is dropped
+ * before being finalized.
+ */
+class SignStream {
+ public:
+  SignStream &update(uint8_t const *const m, size_t const mlen) {
+    hasher.update(m, mlen);
+    return *this;
+  }
+
+  SignStream &update(MsgView const &msg) {
+    hasher.update(msg);
+    return *this;
+  }
+
+ private:
+  friend class Dsig;
+  explicit SignStream(std::unique_ptr<SecretKey> &&sk)
+      : sk{std::move(sk)}, hasher{this->sk->hasher()} {}
+
+  std::unique_ptr<SecretKey> sk;
+  MsgHasher hasher;
+};
+
+/**
+ * @brief A message verified as it is streamed in, between `Dsig::verify_init`
+ *        and `Dsig::verify_final`.
+ *
+ * The signature must outlive the stream. Compact signatures cannot be streamed:
+ * their PK hash is only known once their PK batch is.
+ */
+class VerifyStream {
+ public:
+  VerifyStream &update(uint8_t const *const m, size_t const mlen) {
+    hasher.update(m, mlen);
+    return *this;
+  }
+
+  VerifyStream &update(MsgView const &msg) {
+    hasher.update(msg);
+    return *this;
+  }
+
+ private:
+  friend class Dsig;
+  // Both the fast and slow paths check the HBSS against the PK hash signed in
+  // `pk_sig`, which the fast path first matches with its cached PK.
+  VerifyStream(Signature const &sig, ProcId const pid)
+      : sig{sig}, pid{pid}, hasher{sig.pk_sig.signed_hash, sig.nonce} {}
+
+  Signature const &sig;
+  ProcId const pid;
+  MsgHasher hasher;
+};
+
 class Dsig {
  public:
   Dsig(ProcId id);
@@ -60,28 +126,223 @@ class Dsig {
   Dsig(Dsig &&) = delete;
   Dsig &operator=(Dsig &&) = delete;
 
-  void sign(Signature &sig, uint8_t const *m, size_t mlen);
-  bool verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid);
+  void sign(Signature &sig, uint8_t const *m, size_t mlen) {
+    sign(sig, MsgView(m, mlen));
+  }
+
+  // Signs as `identity`, one of `identities()`.
+  void sign(Signature &sig, uint8_t const *m, size_t mlen, ProcId identity) {
+    sign(sig, MsgView(m, mlen), identity);
+  }
+
+  /**
+   * @brief Signs a message that may be gathered from several buffers.
+   *
+   * The parts are hashed in place, so that, e.g., the header, body and
+   * trailer of an RPC are signed without being copied together first.
+   */
+  void sign(Signature &sig, MsgView const &msg);
+
+  void sign(Signature &sig, MsgView const &msg, ProcId identity);
+
+  /**
+   * @brief Signs only if an SK was already handed to the calling thread.
+   *
+   * @return false if signing would block, in which case `sig` is untouched.
+   */
+  bool try_sign(Signature &sig, uint8_t const *m, size_t mlen) {
+    return try_sign(sig, MsgView(m, mlen));
+  }
+
+  bool try_sign(Signature &sig, uint8_t const *m, size_t mlen, ProcId identity) {
+    return try_sign(sig, MsgView(m, mlen), identity);
+  }
+
+  bool try_sign(Signature &sig, MsgView const &msg);
+
+  bool try_sign(Signature &sig, MsgView const &msg, ProcId identity);
+
+  /**
+   * @brief Signs `nb_reqs` messages in a row.
+   *
+   * Cheaper than as many calls to `sign`: SKs are fetched by groups, all the
+   * messages of a group are hashed before revealing any secret, and the next
+   * SK is prefetched while the current one is used.
+   *
+   * The message hashes are computed one after the other: the multi-lane
+   * BLAKE3 kernel only takes whole single-block inputs, whereas a message
+   * hash covers the PK hash, the nonce and a message of arbitrary length.
+   */
+  void sign_many(SignRequest const *reqs, size_t nb_reqs);
+
+  void sign_many(SignRequest const *reqs, size_t nb_reqs, ProcId identity);
+
+  /**
+   * @brief Starts signing a message that is fed to the stream in parts, e.g.,
+   *        as it is received, without ever being held whole.
+   *
+   * Waits for an SK, as `sign` does.
+   */
+  SignStream sign_init();
+
+  SignStream sign_init(ProcId identity);
+
+  void sign_update(SignStream &stream, uint8_t const *m, size_t mlen) {
+    stream.update(m, mlen);
+  }
+
+  void sign_final(SignStream &&stream, Signature &sig);
+
+  /**
+   * @brief Identities this process signs as, starting with its id.
+   *
+   * Extra identities are listed under `identities` in the config. Each has its
+   * own EdDSA key and SKs, but they all share the background thread, the
+   * workers and the network.
+   */
+  std::vector<ProcId> const &identities() const { return config.myIdentities(); }
+
+  // Budget with which verifications never fall back to the slow path.
+  static constexpr std::chrono::nanoseconds NoBudget = std::chrono::nanoseconds::max();
+
+  bool verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid) {
+    return verify(sig, MsgView(m, mlen), pid);
+  }
+
+  // Verifies a message that may be gathered from several buffers.
+  bool verify(Signature const &sig, MsgView const &msg, ProcId pid);
+
+  /**
+   * @brief Verifies `sig`, waiting for up to `budget` for its PKs.
+   *
+   * If the PKs are not cached, the fast path is retried whenever the background
+   * thread publishes PKs of `pid`. Once `budget` is exhausted, the signature is
+   * verified on the slow path instead.
+   */
+  bool verify(Signature const &sig, MsgView const &msg, ProcId pid,
+              std::chrono::nanoseconds budget);
+
+  bool verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid,
+              std::chrono::nanoseconds budget) {
+    return verify(sig, MsgView(m, mlen), pid, budget);
+  }
+
+  /**
+   * @brief Verifies `nb_reqs` signatures, `valid[i]` receiving the result of
+   *        `reqs[i]`.
+   *
+   * Signatures are grouped by signer and PK batch: each group takes the lock
+   * and looks up its PKs once, then has its HBSS checked in bulk. Groups
+   * whose PKs are missing follow the verify budget, as in `verify`.
+   */
+  void verify_many(VerifyRequest const *reqs, size_t nb_reqs, bool *valid);
+
+  // Starts verifying `sig` over a message that is fed to the stream in parts.
+  VerifyStream verify_init(Signature const &sig, ProcId pid) {
+    return VerifyStream(sig, pid);
+  }
+
+  void verify_update(VerifyStream &stream, uint8_t const *m, size_t mlen) {
+    stream.update(m, mlen);
+  }
+
+  // Verifies the streamed message as `verify` would, budget included.
+  bool verify_final(VerifyStream const &stream) {
+    return verify(stream.sig, MsgView(stream.hasher), stream.pid);
+  }
+
+  bool verify_final(VerifyStream const &stream,
+                    std::chrono::nanoseconds const budget) {
+    return verify(stream.sig, MsgView(stream.hasher), stream.pid, budget);
+  }
+
+  std::optional<bool> try_fast_verify(Signature const &sig, MsgView const &msg,
+                                      ProcId pid);
+
   std::optional<bool> try_fast_verify(Signature const &sig, uint8_t const *m,
-                                      size_t mlen, ProcId pid);
+                                      size_t mlen, ProcId pid) {
+    return try_fast_verify(sig, MsgView(m, mlen), pid);
+  }
+
+  /**
+   * @brief Verifies a compact signature, which requires its PK batch.
+   *
+   * Missing PKs are waited for as per the verify budget. As compact signatures
+   * cannot be verified on the slow path, they are deemed invalid once it is
+   * exhausted.
+   */
+  bool verify(CompactSignature const &sig, MsgView const &msg, ProcId pid);
+
+  bool verify(CompactSignature const &sig, uint8_t const *m, size_t mlen,
+              ProcId pid) {
+    return verify(sig, MsgView(m, mlen), pid);
+  }
+
+  std::optional<bool> try_fast_verify(CompactSignature const &sig,
+                                      MsgView const &msg, ProcId pid);
+
+  std::optional<bool> try_fast_verify(CompactSignature const &sig,
+                                      uint8_t const *m, size_t mlen, ProcId pid) {
+    return try_fast_verify(sig, MsgView(m, mlen), pid);
+  }
+
+  // Rebuilds the full signature of a compact one, if its PK batch is cached.
+  std::optional<Signature> expand(CompactSignature const &sig, ProcId pid);
+
+  bool slow_verify(HorsMerkleSignature const &sig, MsgView const &msg, ProcId pid);
 
   bool slow_verify(HorsMerkleSignature const &sig, uint8_t const *m, size_t mlen,
-                   ProcId pid);
+                   ProcId pid) {
+    return slow_verify(sig, MsgView(m, mlen), pid);
+  }
+
+  bool slow_verify(HorsCompletedSignature const &sig, MsgView const &msg, ProcId pid);
 
   bool slow_verify(HorsCompletedSignature const &sig, uint8_t const *m, size_t mlen,
-                   ProcId pid);
+                   ProcId pid) {
+    return slow_verify(sig, MsgView(m, mlen), pid);
+  }
+
+  bool slow_verify(WotsSignature const &sig, MsgView const &msg, ProcId pid);
 
   bool slow_verify(WotsSignature const &sig, uint8_t const *m, size_t mlen,
-                   ProcId pid);
+                   ProcId pid) {
+    return slow_verify(sig, MsgView(m, mlen), pid);
+  }
+
+  // Enabling the slow path is a zero budget, disabling it is `NoBudget`.
+  void enable_slow_path(bool const enable) {
+    set_verify_budget(enable ? std::chrono::nanoseconds::zero() : NoBudget);
+  }
+
+  // Budget of the verifications that do not specify one.
+  void set_verify_budget(std::chrono::nanoseconds const budget) {
+    verify_budget.store(budget, std::memory_order_relaxed);
+  }
+
+  VerifyStats verify_stats() const { return public_keys.stats(); }
+
+  // CPU that the background thread spent sending PK batches to verifiers.
+  Network::SendStats bg_send_stats() const { return net.send_stats(); }
 
-  void enable_slow_path(bool const enable) { slow_path = enable; }
+  // Only adapts when `sk_depth_min` and `sk_depth_max` differ in the config.
+  SkDepth sk_depth() const { return sk_depth(*signing.front()); }
+
+  SkDepth sk_depth(ProcId const identity) const { return sk_depth(of(identity)); }
 
   void prefetch_sk();
 
+  void prefetch_sk(ProcId identity);
+
   void prefetch_pk(ProcId const pid);
 
+  // Prefetches the PKs that verifying `sig` will read.
+  void prefetch_pk(Signature const &sig, ProcId const pid);
+
   bool replenished_sks(size_t replenished = PreparedSks);
 
+  bool replenished_sks(ProcId identity, size_t replenished);
+
   bool replenished_pks(ProcId const pid, size_t replenished = PreparedSks);
 
  private:
@@ -92,31 +353,80 @@ class Dsig {
 
   // Scheduling thread logic
   void scheduling_loop();
+  // Sum of counters that grow whenever the loop moves keys around: it backs
+  // off once the sum stays put.
+  uint64_t progress() const;
+  // The loop spins for `IdleSpins` idle rounds, then sleeps `IdleSleep` per
+  // round. The slabs are trimmed once it has been idle for `TrimAfter`.
+  static size_t constexpr IdleSpins = 1024;
+  static constexpr std::chrono::microseconds IdleSleep{20};
+  static constexpr std::chrono::seconds TrimAfter{1};
   Workers workers;
 
   PkPipeline pk_pipeline;
   void fetch_ready_pks();
+  uint64_t fetched_pks{0};
+  // Lets the PK pipeline serve first the signers whose PKs run out soonest.
+  void report_pk_demand();
 
-  SkPipeline sk_pipeline;
-  void fetch_ready_sks();
+  // SKs of one of the identities, prepared by the shared workers.
+  struct Identity {
+    Identity(ProcId const id, Network &net, InfCrypto &inf, Workers &workers,
+             size_t const depth_min, size_t const depth_max)
+        : id{id},
+          sk_pipeline{net, inf, workers, id},
+          sk_depth_controller{depth_min, depth_max} {}
+
+    ProcId const id;
+    SkPipeline sk_pipeline;
+    SkDepthController sk_depth_controller;
+    // SKs pushed to `secret_keys` so far, to infer how many were consumed.
+    size_t handed_over{0};
+    // Keys exposed to the application threads via sign
+    SkHandoff secret_keys;
+    // Unused SKs kept across restarts, if configured.
+    std::optional<SkSnapshot> snapshot;
+  };
+  // In the order of `identities()`.
+  std::vector<std::unique_ptr<Identity>> signing;
+  Identity &of(ProcId identity) const;
+  void sign(Identity &identity, Signature &sig, MsgView const &msg);
+  bool try_sign(Identity &identity, Signature &sig, MsgView const &msg);
+  void sign_many(Identity &identity, SignRequest const *reqs, size_t nb_reqs);
+  SkDepth sk_depth(Identity const &identity) const {
+    return {identity.sk_depth_controller.target(),
+            identity.sk_pipeline.prepared() + identity.secret_keys.available()};
+  }
+  void fetch_ready_sks(Identity &identity);
+  void adapt_sk_depth(Identity &identity);
+  void restore_sks(Identity &identity);
+  void save_sks(Identity &identity);
 
   // Scheduling thread control
   std::thread scheduler;
   void stop_scheduler() {
     stop = true;
     scheduler.join();
+    // The workers reference the keys owned by the pipelines.
+    workers.stop();
   }
   std::atomic<bool> stop = false;
 
-  // Keys exposed to the application threads via sign/verify
-  std::map<ProcId, PkCache> public_keys;
-  Mutex pk_mutex;
-  std::deque<std::unique_ptr<SecretKey>> secret_keys;
-  Mutex sk_mutex;
-  std::condition_variable_any sk_cond_var;
+  // Keys exposed to the application threads via verify
+  PkStore public_keys;
+  // Number of SKs that `sign_many` fetches at once.
+  static size_t constexpr SignManyGroup = 16;
+
+  std::atomic<std::chrono::nanoseconds> verify_budget{NoBudget};
+  // Fast verifies `sig`, retrying for up to `budget` if its PKs are missing.
+  template <typename Sig>
+  std::optional<bool> fast_verify_within(Sig const &sig, MsgView const &msg,
+                                         ProcId pid,
+                                         std::chrono::nanoseconds budget);
 
-  bool slow_path = false;
+  // Completes verifications without blocking, as per the budget and the PKs.
+  friend class AsyncDsig;
 
   LOGGER_DECL_INIT(logger, "Dsig");
 };
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -0,0 +1,63 @@
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <toml.hpp>
+
+#include "any.hpp"
+
+namespace dory::anydsig {
+using Factory = std::unique_ptr<Engine> (*)(ProcId);
+
+// `export/internal/engines.inc` is generated from `DSIG_ENGINES`.
+#define DSIG_ENGINE(name, factory) std::unique_ptr<Engine> factory(ProcId id);
+#include "export/internal/engines.inc"
+#undef DSIG_ENGINE
+
+static std::pair<char const *, Factory> constexpr Engines[] = {
+#define DSIG_ENGINE(name, factory) {name, &factory},
+#include "export/internal/engines.inc"
+#undef DSIG_ENGINE
+};
+
+static std::string configured_scheme() {
+  char const *env_config_path = getenv("DSIG_CONFIG");
+  char const *config_path = env_config_path ? env_config_path : "dsig.toml";
+
+  toml::table tbl;
+  try {
+    tbl = toml::parse_file(config_path);
+  } catch (const toml::parse_error &err) {
+    throw std::runtime_error("Failed to parse DSIG_CONFIG");
+  }
+
+  auto const scheme = tbl["scheme"].value<std::string>();
+  if (!scheme) {
+    throw std::runtime_error(fmt::format(
+        "You must provide the `scheme` in the DSIG_CONFIG, one of {}", AnyDsig::schemes()));
+  }
+  return *scheme;
+}
+
+__attribute__((visibility("default"))) std::vector<std::string> AnyDsig::schemes() {
+  std::vector<std::string> names;
+  for (auto const &[name, _] : Engines) names.emplace_back(name);
+  return names;
+}
+
+__attribute__((visibility("default"))) AnyDsig::AnyDsig(ProcId const id)
+    : name{configured_scheme()} {
+  for (auto const &[engine_name, factory] : Engines) {
+    if (name == engine_name) {
+      engine = factory(id);
+      return;
+    }
+  }
+  throw std::runtime_error(fmt::format(
+      "Unknown `scheme` {} in the DSIG_CONFIG, expected one of {}", name, schemes()));
+}
+}  // namespace dory::anydsig
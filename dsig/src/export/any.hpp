@@ -0,0 +1,156 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Independent of the compile-time configuration: each engine is a complete
+// Dsig compiled with its own, and signatures are opaque bytes.
+namespace dory::anydsig {
+using ProcId = int;
+
+// Entry of a batched sign: `sig` receives the signature of `m[0..mlen)`.
+struct SignRequest {
+  uint8_t *sig;
+  uint8_t const *m;
+  size_t mlen;
+};
+
+// Entry of a batched verify: `sig` should sign `m[0..mlen)` on behalf of `pid`.
+struct VerifyRequest {
+  uint8_t const *sig;
+  uint8_t const *m;
+  size_t mlen;
+  ProcId pid;
+};
+
+/**
+ * @brief A Dsig of one configuration, behind a single virtual dispatch.
+ *
+ * Covers the signing (as any identity, one or many messages at once), the
+ * verification (full or compact signatures, one or many at once) and the
+ * verify budget of `DsigLib`. Gathered messages, per-call budgets, the stats
+ * and the asynchronous API are only available with a fixed configuration.
+ */
+class Engine {
+ public:
+  virtual ~Engine() = default;
+
+  virtual size_t signatureSize() const = 0;
+  virtual size_t compactSignatureSize() const = 0;
+
+  // `sig` must point to `signatureSize()` bytes.
+  virtual void sign(uint8_t *sig, uint8_t const *m, size_t mlen) = 0;
+  virtual void sign(uint8_t *sig, uint8_t const *m, size_t mlen,
+                    ProcId identity) = 0;
+  virtual bool trySign(uint8_t *sig, uint8_t const *m, size_t mlen) = 0;
+  virtual bool trySign(uint8_t *sig, uint8_t const *m, size_t mlen,
+                       ProcId identity) = 0;
+  virtual void signMany(SignRequest const *reqs, size_t nb_reqs) = 0;
+  virtual void signMany(SignRequest const *reqs, size_t nb_reqs,
+                        ProcId identity) = 0;
+  virtual std::vector<ProcId> identities() const = 0;
+
+  virtual bool verify(uint8_t const *sig, uint8_t const *m, size_t mlen,
+                      ProcId pid) = 0;
+  virtual void verifyMany(VerifyRequest const *reqs, size_t nb_reqs,
+                          bool *valid) = 0;
+
+  // `csig` must point to `compactSignatureSize()` bytes.
+  virtual void compact(uint8_t *csig, uint8_t const *sig) const = 0;
+  virtual bool verifyCompact(uint8_t const *csig, uint8_t const *m,
+                             size_t mlen, ProcId pid) = 0;
+  // Returns false if the PK batch of `csig` is not cached.
+  virtual bool expand(uint8_t *sig, uint8_t const *csig, ProcId pid) = 0;
+
+  virtual void setVerifyBudget(std::chrono::nanoseconds budget) = 0;
+  virtual bool replenishedSks(size_t replenished) = 0;
+  virtual bool replenishedPks(ProcId pid, size_t replenished) = 0;
+};
+
+/**
+ * @brief Dsig whose HBSS and hashing schemes are picked at construction, by
+ *        name, from the `scheme` of the DSIG_CONFIG.
+ *
+ * All the engines listed in `DSIG_ENGINES` (see CMakeLists.txt) are compiled
+ * in, each with its hot paths fully specialized. Names read
+ * `<hbss>-<hash>-b<log batch size>-<d<wots depth>|k<hors secrets/sig>>`, e.g.,
+ * `wots-blake3-b7-d4`.
+ */
+class AnyDsig {
+ public:
+  AnyDsig(ProcId id);
+
+  static std::vector<std::string> schemes();
+  std::string const &scheme() const { return name; }
+
+  size_t signatureSize() const { return engine->signatureSize(); }
+  size_t compactSignatureSize() const { return engine->compactSignatureSize(); }
+
+  void sign(uint8_t *sig, uint8_t const *m, size_t mlen) {
+    engine->sign(sig, m, mlen);
+  }
+
+  void sign(uint8_t *sig, uint8_t const *m, size_t mlen, ProcId identity) {
+    engine->sign(sig, m, mlen, identity);
+  }
+
+  bool trySign(uint8_t *sig, uint8_t const *m, size_t mlen) {
+    return engine->trySign(sig, m, mlen);
+  }
+
+  bool trySign(uint8_t *sig, uint8_t const *m, size_t mlen, ProcId identity) {
+    return engine->trySign(sig, m, mlen, identity);
+  }
+
+  void signMany(SignRequest const *reqs, size_t nb_reqs) {
+    engine->signMany(reqs, nb_reqs);
+  }
+
+  void signMany(SignRequest const *reqs, size_t nb_reqs, ProcId identity) {
+    engine->signMany(reqs, nb_reqs, identity);
+  }
+
+  std::vector<ProcId> identities() const { return engine->identities(); }
+
+  bool verify(uint8_t const *sig, uint8_t const *m, size_t mlen, ProcId pid) {
+    return engine->verify(sig, m, mlen, pid);
+  }
+
+  void verifyMany(VerifyRequest const *reqs, size_t nb_reqs, bool *valid) {
+    engine->verifyMany(reqs, nb_reqs, valid);
+  }
+
+  void compact(uint8_t *csig, uint8_t const *sig) const {
+    engine->compact(csig, sig);
+  }
+
+  bool verifyCompact(uint8_t const *csig, uint8_t const *m, size_t mlen,
+                     ProcId pid) {
+    return engine->verifyCompact(csig, m, mlen, pid);
+  }
+
+  bool expand(uint8_t *sig, uint8_t const *csig, ProcId pid) {
+    return engine->expand(sig, csig, pid);
+  }
+
+  void setVerifyBudget(std::chrono::nanoseconds budget) {
+    engine->setVerifyBudget(budget);
+  }
+
+  bool replenishedSks(size_t replenished) {
+    return engine->replenishedSks(replenished);
+  }
+
+  bool replenishedPks(ProcId pid, size_t replenished) {
+    return engine->replenishedPks(pid, replenished);
+  }
+
+ private:
+  std::string name;
+  std::unique_ptr<Engine> engine;
+};
+}  // namespace dory::anydsig
@@ -2,10 +2,12 @@
 
 #include <array>
 
-namespace dory::dsig {
+#include "namespace.hpp"
+
+namespace dory::DSIG_NS {
 
 using ProcId = int;
 using Hash = std::array<uint8_t, 32>;
 using HalfHash = std::array<uint8_t, 16>;
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
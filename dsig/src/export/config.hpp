@@ -4,6 +4,8 @@
 #include <array>
 #include <cstddef>
 
+#include "namespace.hpp"
+
 // Non-standard directive, but both gcc and clang provide it
 #if defined __has_include
 #if __has_include("internal/compile-time-config.hpp")
@@ -25,7 +27,7 @@
 #error "Define LOG_INF_BATCH_SIZE"
 #endif
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 #define HORS_MERKLE 0
 #define HORS_COMPLETED 1
@@ -109,7 +111,7 @@ static_assert(SecretsDepth > 1);
 size_t constexpr LogInfBatchSize = LOG_INF_BATCH_SIZE;
 size_t constexpr InfBatchSize = 1 << LogInfBatchSize;
 size_t constexpr PreparedSks = std::max(InfBatchSize, 512ul);
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
 
 #if defined __has_include
 #if __has_include("internal/compile-time-config.hpp")
@@ -3,11 +3,14 @@
 #include <cstdint>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
+#include "../async.hpp"
 #include "../dsig.hpp"
 #include "dsig.hpp"
+#include "namespace.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 __attribute__((visibility("default"))) void DsigLib::DsigDeleter::operator()(
     Dsig *ptr) const {
   delete ptr;
@@ -22,11 +25,133 @@ __attribute__((visibility("default"))) void DsigLib::sign(Signature &sig,
   impl->sign(sig, m, mlen);
 }
 
+__attribute__((visibility("default"))) void DsigLib::signMany(
+    SignRequest const *reqs, size_t nb_reqs) {
+  impl->sign_many(reqs, nb_reqs);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::trySign(
+    Signature &sig, uint8_t const *m, size_t mlen) {
+  return impl->try_sign(sig, m, mlen);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::trySign(
+    Signature &sig, uint8_t const *m, size_t mlen, ProcId const identity) {
+  return impl->try_sign(sig, m, mlen, identity);
+}
+
+__attribute__((visibility("default"))) void DsigLib::sign(
+    Signature &sig, uint8_t const *m, size_t mlen, ProcId const identity) {
+  impl->sign(sig, m, mlen, identity);
+}
+
+__attribute__((visibility("default"))) void DsigLib::signMany(
+    SignRequest const *reqs, size_t nb_reqs, ProcId const identity) {
+  impl->sign_many(reqs, nb_reqs, identity);
+}
+
+__attribute__((visibility("default"))) std::vector<ProcId>
+DsigLib::identities() const {
+  return impl->identities();
+}
+
+__attribute__((visibility("default"))) void DsigLib::sign(
+    Signature &sig, iovec const *iov, size_t iovcnt) {
+  impl->sign(sig, MsgView(iov, iovcnt));
+}
+
+__attribute__((visibility("default"))) void DsigLib::sign(
+    Signature &sig, iovec const *iov, size_t iovcnt, ProcId const identity) {
+  impl->sign(sig, MsgView(iov, iovcnt), identity);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::verify(
+    Signature const &sig, iovec const *iov, size_t iovcnt, ProcId pid) {
+  return impl->verify(sig, MsgView(iov, iovcnt), pid);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::verify(
+    Signature const &sig, iovec const *iov, size_t iovcnt, ProcId pid,
+    std::chrono::nanoseconds const budget) {
+  return impl->verify(sig, MsgView(iov, iovcnt), pid, budget);
+}
+
+__attribute__((visibility("default"))) void DsigLib::StreamDeleter::operator()(
+    SignStream *ptr) const {
+  delete ptr;
+}
+
+__attribute__((visibility("default"))) void DsigLib::StreamDeleter::operator()(
+    VerifyStream *ptr) const {
+  delete ptr;
+}
+
+__attribute__((visibility("default"))) DsigLib::SignStreamPtr
+DsigLib::signInit() {
+  return SignStreamPtr(new SignStream(impl->sign_init()));
+}
+
+__attribute__((visibility("default"))) DsigLib::SignStreamPtr
+DsigLib::signInit(ProcId const identity) {
+  return SignStreamPtr(new SignStream(impl->sign_init(identity)));
+}
+
+__attribute__((visibility("default"))) void DsigLib::signUpdate(
+    SignStream &stream, uint8_t const *m, size_t mlen) {
+  impl->sign_update(stream, m, mlen);
+}
+
+__attribute__((visibility("default"))) void DsigLib::signFinal(
+    SignStreamPtr stream, Signature &sig) {
+  impl->sign_final(std::move(*stream), sig);
+}
+
+__attribute__((visibility("default"))) DsigLib::VerifyStreamPtr
+DsigLib::verifyInit(Signature const &sig, ProcId pid) {
+  return VerifyStreamPtr(new VerifyStream(impl->verify_init(sig, pid)));
+}
+
+__attribute__((visibility("default"))) void DsigLib::verifyUpdate(
+    VerifyStream &stream, uint8_t const *m, size_t mlen) {
+  impl->verify_update(stream, m, mlen);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::verifyFinal(
+    VerifyStreamPtr stream) {
+  return impl->verify_final(*stream);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::verifyFinal(
+    VerifyStreamPtr stream, std::chrono::nanoseconds const budget) {
+  return impl->verify_final(*stream, budget);
+}
+
 __attribute__((visibility("default"))) bool DsigLib::verify(
     Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid) {
   return impl->verify(sig, m, mlen, pid);
 }
 
+__attribute__((visibility("default"))) bool DsigLib::verify(
+    Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid,
+    std::chrono::nanoseconds const budget) {
+  return impl->verify(sig, m, mlen, pid, budget);
+}
+
+__attribute__((visibility("default"))) bool DsigLib::verify(
+    CompactSignature const &sig, uint8_t const *m, size_t mlen, ProcId pid) {
+  return impl->verify(sig, m, mlen, pid);
+}
+
+__attribute__((visibility("default"))) std::optional<Signature>
+DsigLib::expand(CompactSignature const &sig, ProcId pid) {
+  return impl->expand(sig, pid);
+}
+
+__attribute__((visibility("default"))) void DsigLib::verifyMany(
+    VerifyRequest const *reqs, size_t nb_reqs, bool *valid) {
+  impl->verify_many(reqs, nb_reqs, valid);
+}
+
 __attribute__((visibility("default"))) std::optional<bool>
 DsigLib::tryFastVerify(Signature const &sig, uint8_t const *m, size_t mlen,
                        ProcId pid) {
@@ -43,6 +168,25 @@ __attribute__((visibility("default"))) void DsigLib::enableSlowPath(
   impl->enable_slow_path(enable);
 }
 
+__attribute__((visibility("default"))) void DsigLib::setVerifyBudget(
+    std::chrono::nanoseconds const budget) {
+  impl->set_verify_budget(budget);
+}
+
+__attribute__((visibility("default"))) VerifyStats DsigLib::verifyStats()
+    const {
+  return impl->verify_stats();
+}
+
+__attribute__((visibility("default"))) SkDepth DsigLib::skDepth() const {
+  return impl->sk_depth();
+}
+
+__attribute__((visibility("default"))) SkDepth DsigLib::skDepth(
+    ProcId const identity) const {
+  return impl->sk_depth(identity);
+}
+
 __attribute__((visibility("default"))) bool DsigLib::replenishedSks(
     size_t replenished) {
   return impl->replenished_sks(replenished);
@@ -53,4 +197,43 @@ __attribute__((visibility("default"))) bool DsigLib::replenishedPks(
   return impl->replenished_pks(pid, replenished);
 }
 
-}  // namespace dory::dsig
+__attribute__((visibility("default"))) void
+AsyncDsigLib::AsyncDsigDeleter::operator()(AsyncDsig *ptr) const {
+  delete ptr;
+}
+
+__attribute__((visibility("default"))) AsyncDsigLib::AsyncDsigLib(DsigLib &lib)
+    : impl{std::unique_ptr<AsyncDsig, AsyncDsigDeleter>(new AsyncDsig(*lib.impl),
+                                                        AsyncDsigDeleter())} {}
+
+__attribute__((visibility("default"))) void AsyncDsigLib::sign(
+    uint8_t const *m, size_t mlen, SignCallback cb) {
+  impl->sign(m, mlen, std::move(cb));
+}
+
+__attribute__((visibility("default"))) void AsyncDsigLib::sign(
+    uint8_t const *m, size_t mlen, ProcId const identity, SignCallback cb) {
+  impl->sign(m, mlen, identity, std::move(cb));
+}
+
+__attribute__((visibility("default"))) void AsyncDsigLib::verify(
+    Signature const &sig, uint8_t const *m, size_t mlen, ProcId const pid,
+    VerifyCallback cb) {
+  impl->verify(sig, m, mlen, pid, std::move(cb));
+}
+
+__attribute__((visibility("default"))) void AsyncDsigLib::verify(
+    Signature const &sig, uint8_t const *m, size_t mlen, ProcId const pid,
+    std::chrono::nanoseconds const budget, VerifyCallback cb) {
+  impl->verify(sig, m, mlen, pid, budget, std::move(cb));
+}
+
+__attribute__((visibility("default"))) size_t AsyncDsigLib::poll() {
+  return impl->poll();
+}
+
+__attribute__((visibility("default"))) size_t AsyncDsigLib::inFlight() const {
+  return impl->in_flight();
+}
+
+}  // namespace dory::DSIG_NS
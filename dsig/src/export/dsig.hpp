@@ -1,29 +1,85 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <vector>
+
+#include <sys/uio.h>
 
 #include "config.hpp"
+#include "namespace.hpp"
 #include "types.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 class Dsig;
+class AsyncDsig;
+class SignStream;
+class VerifyStream;
 
 class DsigLib {
+  struct StreamDeleter {
+    void operator()(SignStream *) const;
+    void operator()(VerifyStream *) const;
+  };
+
  public:
+  using SignStreamPtr = std::unique_ptr<SignStream, StreamDeleter>;
+  using VerifyStreamPtr = std::unique_ptr<VerifyStream, StreamDeleter>;
+
   DsigLib(ProcId id);
 
   void sign(Signature &sig, uint8_t const *m, size_t mlen);
+  void signMany(SignRequest const *reqs, size_t nb_reqs);
+
+  // Returns false instead of waiting for an SK.
+  bool trySign(Signature &sig, uint8_t const *m, size_t mlen);
+  bool trySign(Signature &sig, uint8_t const *m, size_t mlen, ProcId identity);
+
+  // Multi-identity mode: signs as one of `identities()`.
+  void sign(Signature &sig, uint8_t const *m, size_t mlen, ProcId identity);
+  void signMany(SignRequest const *reqs, size_t nb_reqs, ProcId identity);
+  std::vector<ProcId> identities() const;
+
+  // Messages gathered from `iovcnt` buffers, signed without copying them.
+  void sign(Signature &sig, iovec const *iov, size_t iovcnt);
+  void sign(Signature &sig, iovec const *iov, size_t iovcnt, ProcId identity);
+  bool verify(Signature const &sig, iovec const *iov, size_t iovcnt, ProcId pid);
+  bool verify(Signature const &sig, iovec const *iov, size_t iovcnt, ProcId pid,
+              std::chrono::nanoseconds budget);
+
+  // Messages streamed in parts between init and final, never held whole.
+  // `signInit` waits for an SK, which is lost if the stream is not finalized.
+  SignStreamPtr signInit();
+  SignStreamPtr signInit(ProcId identity);
+  void signUpdate(SignStream &stream, uint8_t const *m, size_t mlen);
+  void signFinal(SignStreamPtr stream, Signature &sig);
+  // `sig` must outlive the stream.
+  VerifyStreamPtr verifyInit(Signature const &sig, ProcId pid);
+  void verifyUpdate(VerifyStream &stream, uint8_t const *m, size_t mlen);
+  bool verifyFinal(VerifyStreamPtr stream);
+  bool verifyFinal(VerifyStreamPtr stream, std::chrono::nanoseconds budget);
 
   bool verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid);
+  bool verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid,
+              std::chrono::nanoseconds budget);
+  bool verify(CompactSignature const &sig, uint8_t const *m, size_t mlen,
+              ProcId pid);
+  std::optional<Signature> expand(CompactSignature const &sig, ProcId pid);
+  void verifyMany(VerifyRequest const *reqs, size_t nb_reqs, bool *valid);
   std::optional<bool> tryFastVerify(Signature const &sig, uint8_t const *m,
                                     size_t mlen, ProcId pid);
   bool slowVerify(Signature const &sig, uint8_t const *m, size_t mlen,
                   ProcId pid);
 
   void enableSlowPath(bool enable);
+  void setVerifyBudget(std::chrono::nanoseconds budget);
+  VerifyStats verifyStats() const;
+  SkDepth skDepth() const;
+  SkDepth skDepth(ProcId identity) const;
 
   bool replenishedSks(size_t replenished = PreparedSks);
 
@@ -34,5 +90,38 @@ class DsigLib {
     void operator()(Dsig *) const;
   };
   std::unique_ptr<Dsig, DsigDeleter> impl;
+  friend class AsyncDsigLib;
+};
+
+/**
+ * @brief Sign/verify operations completed by `poll`, which calls their
+ *        callbacks, rather than blocking the caller.
+ *
+ * Each queue belongs to the thread that polls it. Messages and signatures must
+ * outlive the completion of their operation.
+ */
+class AsyncDsigLib {
+ public:
+  using SignCallback = std::function<void(Signature const &)>;
+  using VerifyCallback = std::function<void(bool)>;
+
+  AsyncDsigLib(DsigLib &lib);
+
+  void sign(uint8_t const *m, size_t mlen, SignCallback cb);
+  void sign(uint8_t const *m, size_t mlen, ProcId identity, SignCallback cb);
+  void verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid,
+              VerifyCallback cb);
+  void verify(Signature const &sig, uint8_t const *m, size_t mlen, ProcId pid,
+              std::chrono::nanoseconds budget, VerifyCallback cb);
+
+  // Returns the number of completed operations.
+  size_t poll();
+  size_t inFlight() const;
+
+ private:
+  struct AsyncDsigDeleter {
+    void operator()(AsyncDsig *) const;
+  };
+  std::unique_ptr<AsyncDsig, AsyncDsigDeleter> impl;
 };
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
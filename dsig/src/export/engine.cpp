@@ -0,0 +1,148 @@
+// Compiled once per engine of `DSIG_ENGINES` (see CMakeLists.txt), with the
+// configuration macros of the engine, its namespace `DSIG_NS` and the name of
+// its factory `DSIG_ENGINE_FACTORY`.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../dsig.cpp"
+#include "../pinning.cpp"
+#include "../sanity/compile-time.cpp"
+#include "../sanity/run-time.cpp"
+
+#include "any.hpp"
+
+namespace dory::anydsig {
+namespace {
+class EngineImpl : public Engine {
+  using Dsig = DSIG_NS::Dsig;
+  using Signature = DSIG_NS::Signature;
+  using CompactSignature = DSIG_NS::CompactSignature;
+
+ public:
+  EngineImpl(ProcId const id) : dsig{id} {}
+
+  size_t signatureSize() const override { return sizeof(Signature); }
+  size_t compactSignatureSize() const override { return sizeof(CompactSignature); }
+
+  // Signatures are copied as they may be unaligned.
+  void sign(uint8_t *const sig, uint8_t const *const m, size_t const mlen) override {
+    Signature signature;
+    dsig.sign(signature, m, mlen);
+    std::memcpy(sig, &signature, sizeof(signature));
+  }
+
+  void sign(uint8_t *const sig, uint8_t const *const m, size_t const mlen,
+            ProcId const identity) override {
+    Signature signature;
+    dsig.sign(signature, m, mlen, identity);
+    std::memcpy(sig, &signature, sizeof(signature));
+  }
+
+  bool trySign(uint8_t *const sig, uint8_t const *const m, size_t const mlen) override {
+    Signature signature;
+    if (!dsig.try_sign(signature, m, mlen)) return false;
+    std::memcpy(sig, &signature, sizeof(signature));
+    return true;
+  }
+
+  bool trySign(uint8_t *const sig, uint8_t const *const m, size_t const mlen,
+               ProcId const identity) override {
+    Signature signature;
+    if (!dsig.try_sign(signature, m, mlen, identity)) return false;
+    std::memcpy(sig, &signature, sizeof(signature));
+    return true;
+  }
+
+  void signMany(SignRequest const *const reqs, size_t const nb_reqs) override {
+    signManyVia(reqs, nb_reqs, [&](auto const *typed) {
+      dsig.sign_many(typed, nb_reqs);
+    });
+  }
+
+  void signMany(SignRequest const *const reqs, size_t const nb_reqs,
+                ProcId const identity) override {
+    signManyVia(reqs, nb_reqs, [&](auto const *typed) {
+      dsig.sign_many(typed, nb_reqs, identity);
+    });
+  }
+
+  std::vector<ProcId> identities() const override { return dsig.identities(); }
+
+  bool verify(uint8_t const *const sig, uint8_t const *const m, size_t const mlen,
+              ProcId const pid) override {
+    Signature signature;
+    std::memcpy(&signature, sig, sizeof(signature));
+    return dsig.verify(signature, m, mlen, pid);
+  }
+
+  void verifyMany(VerifyRequest const *const reqs, size_t const nb_reqs,
+                  bool *const valid) override {
+    std::vector<Signature> signatures(nb_reqs);
+    std::vector<DSIG_NS::VerifyRequest> typed(nb_reqs);
+    for (size_t i = 0; i < nb_reqs; i++) {
+      std::memcpy(&signatures[i], reqs[i].sig, sizeof(Signature));
+      typed[i] = {&signatures[i], reqs[i].m, reqs[i].mlen, reqs[i].pid};
+    }
+    dsig.verify_many(typed.data(), nb_reqs, valid);
+  }
+
+  void compact(uint8_t *const csig, uint8_t const *const sig) const override {
+    Signature signature;
+    std::memcpy(&signature, sig, sizeof(signature));
+    auto const compact_signature = DSIG_NS::encode_compact(signature);
+    std::memcpy(csig, &compact_signature, sizeof(compact_signature));
+  }
+
+  bool verifyCompact(uint8_t const *const csig, uint8_t const *const m,
+                     size_t const mlen, ProcId const pid) override {
+    CompactSignature compact_signature;
+    std::memcpy(&compact_signature, csig, sizeof(compact_signature));
+    return dsig.verify(compact_signature, m, mlen, pid);
+  }
+
+  bool expand(uint8_t *const sig, uint8_t const *const csig, ProcId const pid) override {
+    CompactSignature compact_signature;
+    std::memcpy(&compact_signature, csig, sizeof(compact_signature));
+    auto const signature = dsig.expand(compact_signature, pid);
+    if (!signature) return false;
+    std::memcpy(sig, &*signature, sizeof(Signature));
+    return true;
+  }
+
+  void setVerifyBudget(std::chrono::nanoseconds const budget) override {
+    dsig.set_verify_budget(budget);
+  }
+
+  bool replenishedSks(size_t const replenished) override {
+    return dsig.replenished_sks(replenished);
+  }
+
+  bool replenishedPks(ProcId const pid, size_t const replenished) override {
+    return dsig.replenished_pks(pid, replenished);
+  }
+
+ private:
+  template <typename SignMany>
+  static void signManyVia(SignRequest const *const reqs, size_t const nb_reqs,
+                          SignMany &&sign_many) {
+    std::vector<Signature> signatures(nb_reqs);
+    std::vector<DSIG_NS::SignRequest> typed(nb_reqs);
+    for (size_t i = 0; i < nb_reqs; i++) {
+      typed[i] = {&signatures[i], reqs[i].m, reqs[i].mlen};
+    }
+    sign_many(typed.data());
+    for (size_t i = 0; i < nb_reqs; i++) {
+      std::memcpy(reqs[i].sig, &signatures[i], sizeof(Signature));
+    }
+  }
+
+  Dsig dsig;
+};
+}  // namespace
+
+std::unique_ptr<Engine> DSIG_ENGINE_FACTORY(ProcId const id) {
+  return std::make_unique<EngineImpl>(id);
+}
+}  // namespace dory::anydsig
@@ -0,0 +1,8 @@
+#pragma once
+
+// Namespace of Dsig within `dory`. Each engine of `AnyDsig` is a whole Dsig
+// compiled in a namespace of its own (see CMakeLists.txt), which keeps the
+// symbols of the different configurations apart within dorydsig.
+#ifndef DSIG_NS
+#define DSIG_NS dsig
+#endif
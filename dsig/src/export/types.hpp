@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -11,8 +12,9 @@
 #include "../merkle.hpp"
 #include "base-types.hpp"
 #include "config.hpp"
+#include "namespace.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 using ProcId = int;
 
@@ -85,4 +87,83 @@ template<> struct SchemeToSignature<HorsCompleted> { using Signature = HorsCompl
 template<> struct SchemeToSignature<Wots> { using Signature = WotsSignature; };
 using Signature = SchemeToSignature<HbssScheme>::Signature;
 
-}  // namespace dory::dsig
+/**
+ * @brief Compact wire format of a signature.
+ *
+ * The PK batch is referenced by id and the PK by index, instead of carrying the
+ * batched Inf signature (signed hash, Merkle proof, root signature). Only
+ * verifiers that hold the batch can verify it: slow-path consumers need the
+ * full `Signature`, which such a verifier can rebuild.
+ */
+struct __attribute__((__packed__)) CompactSignature {
+  using BatchId = uint64_t;
+  // The HBSS part of a signature follows its nonce.
+  static size_t constexpr HbssOffset = offsetof(Signature, nonce) + sizeof(Nonce);
+  static size_t constexpr HbssSize = sizeof(Signature) - HbssOffset;
+
+  BatchId batch_id;
+  uint32_t index;
+  Nonce pk_nonce;
+  Nonce nonce;
+  std::array<uint8_t, HbssSize> hbss;
+};
+
+// Root signatures look random: their first bytes identify the batch.
+inline CompactSignature::BatchId compact_batch_id(
+    BatchedInfSignature::InfSignature const &root_sig) {
+  CompactSignature::BatchId id{0};
+  std::memcpy(&id, &root_sig, std::min(sizeof(id), sizeof(root_sig)));
+  return id;
+}
+
+inline CompactSignature encode_compact(Signature const &sig) {
+  CompactSignature csig;
+  csig.batch_id = compact_batch_id(sig.pk_sig.root_sig);
+  csig.index = static_cast<uint32_t>(sig.pk_sig.index);
+  csig.pk_nonce = sig.pk_nonce;
+  csig.nonce = sig.nonce;
+  std::memcpy(csig.hbss.data(), reinterpret_cast<uint8_t const *>(&sig) + CompactSignature::HbssOffset,
+              CompactSignature::HbssSize);
+  return csig;
+}
+
+// `pk_sig` must be the batched Inf signature of the PK referenced by `csig`.
+inline Signature decode_compact(CompactSignature const &csig,
+                                BatchedInfSignature const &pk_sig) {
+  Signature sig{csig.pk_nonce, pk_sig, csig.nonce};
+  std::memcpy(reinterpret_cast<uint8_t *>(&sig) + CompactSignature::HbssOffset, csig.hbss.data(),
+              CompactSignature::HbssSize);
+  return sig;
+}
+
+// Entry of a batched sign: `*sig` receives the signature of `m[0..mlen)`.
+struct SignRequest {
+  Signature *sig;
+  uint8_t const *m;
+  size_t mlen;
+};
+
+// Entry of a batched verify: `sig` should sign `m[0..mlen)` on behalf of `pid`.
+struct VerifyRequest {
+  Signature const *sig;
+  uint8_t const *m;
+  size_t mlen;
+  ProcId pid;
+};
+
+// How verifications ended: on the fast path right away, on the fast path after
+// waiting for the PKs, or on the slow path.
+struct VerifyStats {
+  uint64_t fast;
+  uint64_t waited;
+  uint64_t slow;
+};
+
+// Number of SKs that the background thread aims to keep prepared, and how
+// many are (being) prepared.
+struct SkDepth {
+  size_t target;
+  size_t current;
+};
+
+}  // namespace dory::DSIG_NS
@@ -7,27 +7,24 @@
 #include <dory/shared/branching.hpp>
 
 #include "config.hpp"
+#include "export/namespace.hpp"
+#include "message.hpp"
 #include "types.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 /**
  * @brief A hash large enough know which secrets to reveal.
  *
  */
 class HorsHash {
-  struct Prefix {
-    Hash pk_hash;
-    Nonce nonce;
-  };
  public:
-  HorsHash(Hash const& pk_hash, Nonce const& nonce, uint8_t const* const begin,
-           uint8_t const* const end) {
-    auto hasher = crypto::hash::blake3_init();
-    Prefix prefix = {pk_hash, nonce};
-    crypto::hash::blake3_update(hasher, prefix);
-    crypto::hash::blake3_update(hasher, begin, end);
-    crypto::hash::blake3_final_there(hasher, bytes.data(), bytes.size());
+  HorsHash(Hash const& pk_hash, Nonce const& nonce, MsgView const& msg)
+      : HorsHash(MsgHasher::prefixed(pk_hash, nonce, msg)) {}
+
+  // Finalizes a message that was hashed incrementally.
+  explicit HorsHash(MsgHasher const& hasher) {
+    hasher.final(bytes.data(), bytes.size());
     for (size_t hash_offset = 0, secret = 0; secret < SecretsPerSignature;
          secret++, hash_offset += hors::LogSecretsPerSecretKey) {
       secret_indexes.at(secret) = secretIndexAt(hash_offset);
@@ -71,4 +68,4 @@ class HorsHash {
   std::array<size_t, hors::SecretsPerSignature> secret_indexes;
 };
 
-}  // namespace dory::dsig
\ No newline at end of file
+}  // namespace dory::DSIG_NS
\ No newline at end of file
@@ -3,9 +3,10 @@
 #include <array>
 
 #include "../export/config.hpp"
+#include "../export/namespace.hpp"
 #include "../merkle.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 using BatchMerkleTree = MerkleTree<LogInfBatchSize>;
 using BatchMerkleProof = MerkleProof<BatchMerkleTree>;
@@ -1,10 +1,11 @@
 #pragma once
 
+#include "../export/namespace.hpp"
 #include "dilithium.hpp"
 #include "eddsa.hpp"
 #include "../config.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 using InfCrypto = EddsaCrypto; // DilithiumCrypto;
 
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <stdexcept>
 #include <unordered_map>
@@ -16,20 +17,29 @@
 
 #include "../config.hpp"
 #include "../export/base-types.hpp"
+#include "../export/namespace.hpp"
 #include "batch.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 class DilithiumCrypto {
  public:
   using Signature = std::array<uint8_t, crypto::asymmetric::dilithium::SignatureLength>;
   using BatchedSignature = Batched<Signature>;
 
-  DilithiumCrypto(ProcId local_id, std::vector<ProcId> const &all_ids)
+  // `identity_hosts` maps the extra identities (i.e., other than the process
+  // ids) to the process that signs on their behalf.
+  DilithiumCrypto(ProcId local_id, std::vector<ProcId> const &all_ids,
+                  std::map<ProcId, ProcId> const &identity_hosts = {})
       : my_id{local_id}, store{nspace}, LOGGER_INIT(logger, "Dsig") {
     crypto::asymmetric::dilithium::init();
 
     LOGGER_INFO(logger, "Publishing my Dilithium key (process {})", my_id);
     crypto::asymmetric::dilithium::publish_pub_key(fmt::format("{}-pubkey", local_id));
+    for (auto const &[identity, host] : identity_hosts) {
+      if (host != local_id) continue;
+      auto &kp = keypairs.emplace(identity, crypto::asymmetric::dilithium::new_keypair()).first->second;
+      crypto::asymmetric::dilithium::publish_pub_key(fmt::format("{}-pubkey", identity), kp);
+    }
 
     LOGGER_INFO(logger, "Waiting for all processes ({}) to publish their keys",
                 all_ids);
@@ -39,6 +49,10 @@ class DilithiumCrypto {
       public_keys.emplace(
           id, crypto::asymmetric::dilithium::get_public_key(fmt::format("{}-pubkey", id)));
     }
+    for (auto const &[identity, _] : identity_hosts) {
+      public_keys.emplace(
+          identity, crypto::asymmetric::dilithium::get_public_key(fmt::format("{}-pubkey", identity)));
+    }
   }
 
   inline Signature sign(uint8_t const *msg,      // NOLINT
@@ -48,6 +62,20 @@ class DilithiumCrypto {
     return sig;
   }
 
+  // Signs as one of the identities hosted by this process.
+  inline Signature sign(uint8_t const *msg, size_t const msg_len,
+                        ProcId const identity) {
+    if (identity == my_id) return sign(msg, msg_len);
+    auto const kp_it = keypairs.find(identity);
+    if (kp_it == keypairs.end()) {
+      throw std::runtime_error(
+          fmt::format("Identity {} is not hosted here!", identity));
+    }
+    Signature sig;
+    crypto::asymmetric::dilithium::sign(sig.data(), msg, msg_len, kp_it->second);
+    return sig;
+  }
+
   inline bool verify(Signature const &sig, uint8_t const *msg,
                      size_t const msg_len, ProcId const node_id) {
     auto pk_it = public_keys.find(node_id);
@@ -59,6 +87,15 @@ class DilithiumCrypto {
     return crypto::asymmetric::dilithium::verify(sig.data(), msg, msg_len, pk_it->second);
   }
 
+  // Dilithium has no batch verification: same as as many calls to `verify`.
+  inline void verify_many(Signature const *const *sigs, uint8_t const *const *msgs,
+                          size_t const *msg_lens, ProcId const *node_ids,
+                          size_t const n, bool *const valid) {
+    for (size_t i = 0; i < n; i++) {
+      valid[i] = verify(*sigs[i], msgs[i], msg_lens[i], node_ids[i]);
+    }
+  }
+
   inline bool verify(BatchedSignature const &sig, ProcId const node_id) {
     auto const root = sig.proof.root(sig.signed_hash, sig.index);
     return verify(sig.root_sig, reinterpret_cast<uint8_t const*>(root.data()), sizeof(root), node_id);
@@ -70,9 +107,12 @@ class DilithiumCrypto {
   ProcId const my_id;
   memstore::MemoryStore store;
 
+  // Keypairs of the extra identities that this process signs as
+  std::unordered_map<ProcId, crypto::asymmetric::dilithium::priv_key> keypairs;
+
   // Map: NodeId (ProcId) -> Node's Public Key
   std::unordered_map<ProcId, crypto::asymmetric::dilithium::pub_key> public_keys;
   LOGGER_DECL(logger);
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
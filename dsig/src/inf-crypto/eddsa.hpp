@@ -2,9 +2,11 @@
 
 #include <array>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 #include <fmt/core.h>
 #include <fmt/ranges.h>
@@ -14,6 +16,7 @@
 
 #include "../config.hpp"
 #include "../export/base-types.hpp"
+#include "../export/namespace.hpp"
 #include "batch.hpp"
 
 // Use Dalek or Sodium
@@ -23,18 +26,26 @@
 // #include <dory/crypto/asymmetric/sodium.hpp>
 // #define crypto_impl dory::crypto::asymmetric::sodium
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 class EddsaCrypto {
  public:
   using Signature = std::array<uint8_t, crypto_impl::SignatureLength>;
   using BatchedSignature = Batched<Signature>;
 
-  EddsaCrypto(ProcId local_id, std::vector<ProcId> const &all_ids)
+  // `identity_hosts` maps the extra identities (i.e., other than the process
+  // ids) to the process that signs on their behalf.
+  EddsaCrypto(ProcId local_id, std::vector<ProcId> const &all_ids,
+              std::map<ProcId, ProcId> const &identity_hosts = {})
       : my_id{local_id}, store{nspace}, LOGGER_INIT(logger, "Dsig") {
     crypto_impl::init();
 
     LOGGER_INFO(logger, "Publishing my EdDSA key (process {})", my_id);
     crypto_impl::publish_pub_key(fmt::format("{}-dsig-pubkey", local_id));
+    for (auto const &[identity, host] : identity_hosts) {
+      if (host != local_id) continue;
+      auto &kp = keypairs.emplace(identity, crypto_impl::new_keypair()).first->second;
+      crypto_impl::publish_pub_key(fmt::format("{}-dsig-pubkey", identity), kp);
+    }
 
     LOGGER_INFO(logger, "Waiting for all processes ({}) to publish their keys",
                 all_ids);
@@ -44,6 +55,10 @@ class EddsaCrypto {
       public_keys.emplace(
           id, crypto_impl::get_public_key(fmt::format("{}-dsig-pubkey", id)));
     }
+    for (auto const &[identity, _] : identity_hosts) {
+      public_keys.emplace(
+          identity, crypto_impl::get_public_key(fmt::format("{}-dsig-pubkey", identity)));
+    }
   }
 
   inline Signature sign(uint8_t const *msg,      // NOLINT
@@ -53,15 +68,45 @@ class EddsaCrypto {
     return sig;
   }
 
-  inline bool verify(Signature const &sig, uint8_t const *msg,
-                     size_t const msg_len, ProcId const node_id) {
-    auto pk_it = public_keys.find(node_id);
-    if (pk_it == public_keys.end()) {
+  // Signs as one of the identities hosted by this process.
+  inline Signature sign(uint8_t const *msg, size_t const msg_len,
+                        ProcId const identity) {
+    if (identity == my_id) return sign(msg, msg_len);
+    auto const kp_it = keypairs.find(identity);
+    if (kp_it == keypairs.end()) {
       throw std::runtime_error(
-          fmt::format("Missing public key for {}!", node_id));
+          fmt::format("Identity {} is not hosted here!", identity));
     }
+    Signature sig;
+    crypto_impl::sign(sig.data(), msg, msg_len, kp_it->second);
+    return sig;
+  }
 
-    return crypto_impl::verify(sig.data(), msg, msg_len, pk_it->second);
+  inline bool verify(Signature const &sig, uint8_t const *msg,
+                     size_t const msg_len, ProcId const node_id) {
+    return crypto_impl::verify(sig.data(), msg, msg_len, public_key(node_id));
+  }
+
+  /**
+   * @brief Verifies `n` signatures, `valid[i]` receiving whether `sigs[i]`
+   *        signs `msgs[i][0..msg_lens[i])` on behalf of `node_ids[i]`.
+   *
+   * They are checked together by Ed25519 batch verification. Only if one of
+   * them is invalid are they checked one by one, to tell which.
+   */
+  inline void verify_many(Signature const *const *sigs, uint8_t const *const *msgs,
+                          size_t const *msg_lens, ProcId const *node_ids,
+                          size_t const n, bool *const valid) {
+    std::vector<uint8_t const *> raw_sigs(n);
+    std::vector<crypto_impl::publickey_t const *> pks(n);
+    for (size_t i = 0; i < n; i++) {
+      raw_sigs[i] = sigs[i]->data();
+      pks[i] = public_key(node_ids[i]).get();
+    }
+    auto const all_valid = crypto_impl::verify_batch(raw_sigs.data(), msgs, msg_lens, pks.data(), n);
+    for (size_t i = 0; i < n; i++) {
+      valid[i] = all_valid || verify(*sigs[i], msgs[i], msg_lens[i], node_ids[i]);
+    }
   }
 
   inline bool verify(BatchedSignature const &sig, ProcId const node_id) {
@@ -72,12 +117,24 @@ class EddsaCrypto {
   inline ProcId myId() const { return my_id; }
 
  private:
+  crypto_impl::pub_key &public_key(ProcId const node_id) {
+    auto pk_it = public_keys.find(node_id);
+    if (pk_it == public_keys.end()) {
+      throw std::runtime_error(
+          fmt::format("Missing public key for {}!", node_id));
+    }
+    return pk_it->second;
+  }
+
   ProcId const my_id;
   memstore::MemoryStore store;
 
+  // Keypairs of the extra identities that this process signs as
+  std::unordered_map<ProcId, crypto_impl::priv_key> keypairs;
+
   // Map: NodeId (ProcId) -> Node's Public Key
   std::unordered_map<ProcId, crypto_impl::pub_key> public_keys;
   LOGGER_DECL(logger);
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -9,7 +9,9 @@
 #include <numeric>
 #include <vector>
 
-namespace dory::dsig {
+#include "export/namespace.hpp"
+
+namespace dory::DSIG_NS {
 
 class LatencyProfiler {
  public:
@@ -210,4 +212,4 @@ class LatencyProfiler {
   std::vector<uint64_t> freq;
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
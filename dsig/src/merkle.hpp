@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <type_traits>
 
@@ -9,8 +10,9 @@
 #include <dory/shared/branching.hpp>
 
 #include "export/config.hpp"
+#include "export/namespace.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 template <size_t _LogNbLeaves, size_t _LogNbRoots = 0>
 struct MerkleTree {
@@ -30,7 +32,23 @@ struct MerkleTree {
     if (build) compute();
   }
 
+  /**
+   * @brief Builds the tree level by level, from the leaves up to the roots.
+   *
+   * The children of a level are contiguous, so all the parents of a level are
+   * hashed with the multi-lane BLAKE3 kernel. Nodes above the roots are unused
+   * and not computed.
+   */
   void compute() {
+    if constexpr (LogNbLeaves > LogNbRoots) {
+      for (size_t level = LogNbLeaves; level-- > LogNbRoots;) {
+        hash_level((1ul << level) - 1, 1ul << level);
+      }
+    }
+  }
+
+  // One parent at a time, kept as a reference for benchmarks.
+  void compute_sequential() {
     if constexpr (NbLeaves == 1) return;
     for (size_t left_child = nodes.size() - 2, parent = NbLeaves - 2;;
       left_child -= 2, parent--) {
@@ -56,6 +74,23 @@ struct MerkleTree {
   Leaves const& leaves() const {
     return *reinterpret_cast<Leaves const*>(nodes.at(NbLeaves - 1).data());
   }
+
+ private:
+  // Hashes the `count` parents starting at node `first`.
+  void hash_level(size_t const first, size_t const count) {
+    using Block = crypto::hash::Blake3Block;
+    static_assert(sizeof(Block) == 2 * sizeof(Hash));
+    // Enough lanes for the widest kernel (AVX-512) to be fed in full.
+    static size_t constexpr Lanes = 32;
+    std::array<Block const*, Lanes> children;
+    for (size_t parent = first; parent < first + count; parent += Lanes) {
+      auto const lanes = std::min(Lanes, first + count - parent);
+      for (size_t i = 0; i < lanes; i++) {
+        children[i] = reinterpret_cast<Block const*>(&nodes[2 * (parent + i) + 1]);
+      }
+      crypto::hash::blake3_many(children.data(), lanes, &nodes[parent]);
+    }
+  }
 };
 
 template <typename MerkleTree>
@@ -66,22 +101,22 @@ struct __attribute__((__packed__)) MerkleProof {
 
   std::array<Hash, MerkleTree::LogNbLeaves - MerkleTree::LogNbRoots> path;
 
+  // `path` goes from the sibling of the leaf up to a child of its root.
   MerkleProof(MerkleTree const& tree, size_t const index) {
-    // Starting from the root
-    size_t node = 0;
-    for (size_t i = 0; i < path.size(); i++) {
-      auto depth = i + MerkleTree::LogNbRoots;
-      auto const leaf_direction =
-          (index >> (path.size() - depth - 1)) & 1;
-      auto left_child = (node << 1) + 1;
-      auto child_in_path = left_child + (1 - leaf_direction);
-      path[path.size() - i - 1] = tree.nodes.at(child_in_path);
-      node = left_child + leaf_direction;
+    auto node = MerkleTree::NbLeaves - 1 + index;
+    for (auto& sibling : path) {
+      sibling = tree.nodes.at(siblingOf(node));
+      node = parentOf(node);
     }
   }
 
+  // Index of the root of the leaf at `index` among the roots of the tree.
+  static size_t rootIndex(size_t const index) {
+    return index >> (MerkleTree::LogNbLeaves - MerkleTree::LogNbRoots);
+  }
+
   Hash root(Hash const& leaf, size_t const index) const {
-    auto directions = index >> MerkleTree::LogNbRoots;
+    auto directions = index;
     auto acc = leaf;
     for (size_t i = 0; i < path.size(); i++) {
       auto direction = directions & 1;
@@ -105,25 +140,31 @@ struct __attribute__((__packed__)) MerkleProof {
       return false;
     }
 
-    // Starting from the root
-    size_t node = 0;
+    auto node = MerkleTree::NbLeaves - 1 + index;
     for (size_t i = 0; i < path.size(); i++) {
-      auto depth = i + MerkleTree::LogNbRoots;
-      auto const leaf_direction =
-          (index >> (path.size() - depth - 1)) & 1;
-      auto left_child = (node << 1) + 1;
-      auto child_in_path = left_child + (1 - leaf_direction);
-      auto const& expected_node = tree.nodes.at(child_in_path);
-      if (unlikely(std::memcmp(&path[path.size() - i - 1], &expected_node, sizeof(expected_node)) != 0)) {
-        fmt::print(stderr, "Invalid path node #{}: {} vs {}", i, path[path.size() - i - 1], expected_node);
+      auto const& expected_node = tree.nodes.at(siblingOf(node));
+      if (unlikely(std::memcmp(&path[i], &expected_node, sizeof(expected_node)) != 0)) {
+        fmt::print(stderr, "Invalid path node #{}: {} vs {}", i, path[i], expected_node);
         return false;
       }
-
-      node = left_child + leaf_direction;
+      node = parentOf(node);
     }
     // return leaf(proof.leaf_index) == proof.leaf;
     return true;
   }
+
+  /**
+   * @brief Checks the proof without the tree, against its (signed) roots.
+   */
+  bool in_roots(Hash const& leaf, size_t const index,
+                typename MerkleTree::Roots const& roots) const {
+    return root(leaf, index) == roots.at(rootIndex(index));
+  }
+
+ private:
+  // Nodes are stored breadth-first: the children of `n` are `2n+1` and `2n+2`.
+  static size_t siblingOf(size_t const node) { return node & 1 ? node + 1 : node - 1; }
+  static size_t parentOf(size_t const node) { return (node - 1) >> 1; }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/uio.h>
+
+#include <dory/crypto/hash/blake3.hpp>
+
+#include "export/namespace.hpp"
+#include "types.hpp"
+
+namespace dory::DSIG_NS {
+class MsgHasher;
+
+/**
+ * @brief A message to sign or verify, either contiguous or gathered from
+ *        several buffers (e.g., the header, body and trailer of an RPC).
+ *
+ * The message is the concatenation of its parts, which are hashed in place:
+ * they are neither copied nor owned, and must outlive the view.
+ *
+ * A view can also stand for a message that was streamed into a `MsgHasher`,
+ * whose parts are gone: only its digest can then be taken.
+ */
+class MsgView {
+ public:
+  MsgView() = default;
+  MsgView(uint8_t const *const m, size_t const mlen) : m{m}, mlen{mlen} {}
+  MsgView(iovec const *const iov, size_t const iovcnt)
+      : iov{iov}, iovcnt{iovcnt} {}
+  explicit MsgView(MsgHasher const &hashed) : hashed_{&hashed} {}
+
+  // The hasher the message was streamed into, if any.
+  MsgHasher const *hashed() const { return hashed_; }
+
+  // Calls `f(data, len)` on each part, in order.
+  template <typename F>
+  void for_each_part(F &&f) const {
+    if (hashed_) {
+      throw std::logic_error("The parts of a streamed message are gone.");
+    }
+    if (!iov) {
+      f(m, mlen);
+      return;
+    }
+    for (size_t i = 0; i < iovcnt; i++) {
+      f(static_cast<uint8_t const *>(iov[i].iov_base), iov[i].iov_len);
+    }
+  }
+
+ private:
+  uint8_t const *m = nullptr;
+  size_t mlen = 0;
+  iovec const *iov = nullptr;
+  size_t iovcnt = 0;
+  MsgHasher const *hashed_ = nullptr;
+};
+
+/**
+ * @brief Incremental hash of a message, from which the HBSS derives the
+ *        secrets to reveal.
+ *
+ * It is prefixed with the hash of the PK and the nonce of the signature, so
+ * that the digest is only known once the SK is. The message can then be fed
+ * in as many parts as needed before `HorsHash`/`WotsHash` finalize it.
+ */
+class MsgHasher {
+  struct Prefix {
+    Hash pk_hash;
+    Nonce nonce;
+  };
+
+ public:
+  MsgHasher(Hash const &pk_hash, Nonce const &nonce)
+      : prefix{pk_hash, nonce}, hasher{crypto::hash::blake3_init()} {
+    crypto::hash::blake3_update(hasher, prefix);
+  }
+
+  /**
+   * @brief Hasher of `msg` prefixed with `pk_hash` and `nonce`.
+   *
+   * A streamed message is only taken as is if it was streamed with the same
+   * prefix, i.e., for the same SK or signature.
+   */
+  static MsgHasher prefixed(Hash const &pk_hash, Nonce const &nonce,
+                            MsgView const &msg) {
+    if (auto const *const hashed = msg.hashed()) {
+      Prefix const expected = {pk_hash, nonce};
+      if (std::memcmp(&hashed->prefix, &expected, sizeof(expected)) != 0) {
+        throw std::logic_error("The message was streamed for another signature.");
+      }
+      return *hashed;
+    }
+    MsgHasher hasher(pk_hash, nonce);
+    hasher.update(msg);
+    return hasher;
+  }
+
+  MsgHasher &update(uint8_t const *const m, size_t const mlen) {
+    crypto::hash::blake3_update(hasher, m, m + mlen);
+    return *this;
+  }
+
+  MsgHasher &update(MsgView const &msg) {
+    msg.for_each_part(
+        [this](uint8_t const *const m, size_t const mlen) { update(m, mlen); });
+    return *this;
+  }
+
+  // Fills `out[0..len)` with the digest of the parts fed so far.
+  void final(uint8_t *const out, size_t const len) const {
+    blake3_hasher_finalize(&hasher, out, len);
+  }
+
+ private:
+  Prefix prefix;
+  crypto::hash::Blake3Hasher hasher;
+};
+
+}  // namespace dory::DSIG_NS
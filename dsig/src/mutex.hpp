@@ -5,7 +5,9 @@
 
 #include <dory/shared/branching.hpp>
 
-namespace dory::dsig {
+#include "export/namespace.hpp"
+
+namespace dory::DSIG_NS {
 
 // Implements the Lockable interface so that it is compatible with std::scoped_lock
 class SpinMutex {
@@ -39,4 +41,4 @@ class SpinMutex {
 // using Mutex = std::mutex;
 using Mutex = SpinMutex;
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <exception>
+#include <map>
 #include <memory_resource>
 #include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <dory/conn/rc-exchanger.hpp>
@@ -18,51 +24,138 @@
 #include <fmt/ranges.h>
 
 #include "config.hpp"
+#include "export/namespace.hpp"
 #include "types.hpp"
 #include "util.hpp"
 #include "pk/pk.hpp"
+#include "relay.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Sends the PK batches to the verifiers and receives those of the
+ *        signers, over one RC per remote process.
+ *
+ * Back-pressure: each process exposes an array of counters indexed by ProcId
+ * in which the remotes RDMA-write how many receives they armed for it. It is
+ * sized after the largest id, so the number of peers is only bounded by the
+ * device. Work requests are identified by their connection, completions of a
+ * QP being in order. On the sending side, each connection holds a bounded
+ * number of send buffers, so that a slow verifier does not stall the others,
+ * and a verifier that lags too many batches behind is skipped until it
+ * catches up: it verifies the signatures of the missed batches on the slow
+ * path, and a crashed verifier only costs its own share of the memory.
+ *
+ * Batches are either sent by signers directly to all the verifiers, or relayed
+ * along a `RelayTree`.
+ */
+class Network {
+  // Batches carry their signer as they may be relayed.
+  struct Message {
+    ProcId signer;
+    BgPublicKeys::Compressed pks;
+  };
 
-namespace dory::dsig {
+  // Registered send buffers shared by all the connections: a batch is copied
+  // once and the same buffer is posted to every target that has room for it.
+  // It is recycled when the last of these sends completes.
+  class SharedSendBuffers {
+   public:
+    void add(void *const buf) {
+      refs.emplace(buf, 0);
+      free.push_back(buf);
+    }
+
+    // Returns a buffer that will be released `uses` times, if any is free.
+    void *acquire(size_t const uses) {
+      if (free.empty()) return nullptr;
+      auto *const buf = free.back();
+      free.pop_back();
+      refs.at(buf) = uses;
+      return buf;
+    }
+
+    void release(void *const buf) {
+      if (--refs.at(buf) == 0) free.push_back(buf);
+    }
+
+   private:
+    std::unordered_map<void *, size_t> refs;
+    std::vector<void *> free;
+  };
 
-class Network {
-  static size_t constexpr MaxId = 31;
-  using Armed = std::array<size_t, MaxId + 1>;
   class Connection {
    public:
-    Connection(ProcId const local_id, ProcId const remote_id, conn::ReliableConnection&& rc, conn::ReliableConnection&& ack_rc, std::pmr::polymorphic_allocator<uint8_t>& rdma_allocator, size_t const hw_credits)
+    // The ack MR holds the counters written by the remotes, then the local
+    // copies of those we write to them, `armed_slots` each.
+    Connection(ProcId const local_id, ProcId const remote_id, conn::ReliableConnection&& rc, conn::ReliableConnection&& ack_rc, std::pmr::polymorphic_allocator<uint8_t>& rdma_allocator, size_t const recv_credits, size_t const armed_slots)
       : local_id{local_id}, remote_id{remote_id}, rc{std::move(rc)}, ack_rc{std::move(ack_rc)},
-        my_notified_armed{&reinterpret_cast<Armed*>(this->ack_rc.getMr().addr + sizeof(Armed))->at(remote_id)},
-        my_notified_armed_dest{&reinterpret_cast<Armed*>(this->ack_rc.remoteBuf())->at(local_id)},
-        remote_notified_armed{&reinterpret_cast<Armed*>(this->ack_rc.getMr().addr)->at(remote_id)},
-        armed_notif_credits{hw_credits} {
-      if (static_cast<size_t>(remote_id) > MaxId) throw std::runtime_error("Remote id > MaxId");
-      for (size_t i = 0; i < hw_credits; i++) {
-        take_send_buffer(rdma_allocator.allocate(sizeof(BgPublicKeys::Compressed)));
-        take_recv_buffer(rdma_allocator.allocate(sizeof(BgPublicKeys::Compressed)));
+        my_notified_armed{reinterpret_cast<size_t*>(this->ack_rc.getMr().addr) + armed_slots + remote_id},
+        my_notified_armed_dest{reinterpret_cast<size_t*>(this->ack_rc.remoteBuf()) + local_id},
+        remote_notified_armed{reinterpret_cast<size_t*>(this->ack_rc.getMr().addr) + remote_id},
+        send_credits{HardwareCredits}, armed_notif_credits{HardwareCredits} {
+      for (size_t i = 0; i < recv_credits; i++) {
+        take_recv_buffer(rdma_allocator.allocate(sizeof(Message)));
       }
     }
 
+    ProcId remoteId() const { return remote_id; }
+
+    // Whether the connection already holds `SendDepth` send buffers, queued or
+    // in flight.
+    bool full() const { return to_send.size() + in_flight.size() >= SendDepth; }
+
+    // Whether the connection should miss the next batch, as it is full and
+    // already lags `MaxLag` pending batches behind.
+    bool overrun() const { return full() && lag >= MaxLag; }
+
+    // Accounts for a pending batch that the connection did not take yet.
+    void fell_behind() { lag++; }
+    void caught_up() { lag--; }
+
+    // Returns whether the connection just started to miss batches.
+    bool skip() { return !std::exchange(skipping, true); }
+
     void tick() {
       rearm_recvs();
       send_queued();
     }
 
-    void send(BgPublicKeys::Compressed const& compressed) {
-      if (!try_send(compressed)) {
-        to_send.emplace_back(compressed);
+    // `buf` is a shared send buffer: only its address is queued.
+    void send(void* buf) {
+      skipping = false;
+      if (!to_send.empty() || !try_send(buf)) {
+        to_send.push_back(buf);
       }
     }
 
-    void take_send_buffer(void* buf) {
-      free_send_bufs.emplace_back(buf);
+    // Returns the buffer of the oldest send, which just completed.
+    void* send_completed() {
+      send_credits++;
+      auto *const buf = in_flight.front();
+      in_flight.pop_front();
+      return buf;
+    }
+
+    // Returns the buffer of the oldest receive, which just completed.
+    void* recv_completed() {
+      auto *const buf = armed_bufs.front();
+      armed_bufs.pop_front();
+      return buf;
     }
 
     void take_recv_buffer(void* buf) {
       free_recv_bufs.emplace_back(buf);
     }
 
-    static size_t constexpr MaxHardwareCredits = 8;
-    static_assert(MaxHardwareCredits < static_cast<size_t>(dory::conn::ReliableConnection::WrDepth));
+    // Sends, receives and armed notifications in flight per connection.
+    static size_t constexpr HardwareCredits = 8;
+    static_assert(HardwareCredits < static_cast<size_t>(dory::conn::ReliableConnection::WrDepth));
+    // Send buffers a connection may hold, so that a slow verifier only pins
+    // its own share of the shared buffers.
+    static size_t constexpr SendDepth = 2 * HardwareCredits;
+    // Pending batches a full connection may lag behind, on top of `SendDepth`.
+    static size_t constexpr MaxLag = HardwareCredits;
 
    private:
     void send_queued() {
@@ -74,14 +167,13 @@ class Network {
       }
     }
 
-    bool try_send(BgPublicKeys::Compressed const& compressed) {
-      if (free_send_bufs.empty() || armed_before() <= sent)
+    bool try_send(void* buf) {
+      if (send_credits == 0 || armed_before() <= sent)
         return false;
-      auto const buf = free_send_bufs.front();
-      free_send_bufs.pop_front();
-      std::memcpy(buf, &compressed, sizeof(compressed));
-      if (!rc.postSendSingleSend(pack(remote_id, buf), buf, sizeof(compressed)))
+      if (!rc.postSendSingleSend(reinterpret_cast<uint64_t>(this), buf, sizeof(Message)))
         throw std::runtime_error(fmt::format("Error while sending to {}", remote_id));
+      in_flight.push_back(buf);
+      send_credits--;
       sent++;
       return true;
     }
@@ -92,9 +184,10 @@ class Network {
         free_recv_bufs.pop_front();
         void *arr[] { buf };
         auto const posted =
-          rc.postRecvMany(pack(remote_id, buf), arr, 1, sizeof(BgPublicKeys::Compressed));
+          rc.postRecvMany(reinterpret_cast<uint64_t>(this), arr, 1, sizeof(Message));
         if (!posted)
           throw std::runtime_error(fmt::format("Error while arming for {}", remote_id));
+        armed_bufs.push_back(buf);
         armed++;
       }
 
@@ -127,32 +220,93 @@ class Network {
     ProcId local_id, remote_id;
 
     conn::ReliableConnection rc;
-    std::deque<void*> free_send_bufs, free_recv_bufs;
+    std::deque<void*> free_recv_bufs, armed_bufs;
 
     conn::ReliableConnection ack_rc;
     size_t armed{0};
     size_t *my_notified_armed, *my_notified_armed_dest, *remote_notified_armed;
 
     size_t sent{0};
-    std::deque<BgPublicKeys::Compressed> to_send;
+    size_t send_credits;
+    std::deque<void*> to_send, in_flight;
+    size_t lag{0};
+    bool skipping{false};
     size_t armed_notif_credits;
     std::vector<struct ibv_wc> wce;
   };
  public:
+  struct SendStats {
+    size_t batches;
+    size_t forwarded;
+    std::chrono::nanoseconds cpu;
+  };
+
+  // `relay_fanout` is the arity of the relay trees, 0 to send directly.
+  // `identity_hosts` maps the extra identities to the process that signs as
+  // them: their batches take the same connections as their host's.
   Network(ctrl::ControlBlock &cb, ProcId my_id,
           std::vector<ProcId> const &remote_ids,
-          std::vector<ProcId> const &verifier_ids)
-      : cb{cb}, store{nspace}, remote_ids{remote_ids}, verifier_ids{verifier_ids} {
-    auto const hw_credits =
-        std::min(static_cast<size_t>(dory::ctrl::ControlBlock::CqDepth /
-                                     remote_ids.size()),
-                 Connection::MaxHardwareCredits);
-    auto [ce, ack_ce] = build_ces(my_id, remote_ids, cb, hw_credits);
+          std::vector<ProcId> const &signer_ids,
+          std::vector<ProcId> const &verifier_ids,
+          size_t const relay_fanout = 0,
+          std::map<ProcId, ProcId> const &identity_hosts = {})
+      : cb{cb}, store{nspace}, my_id{my_id}, remote_ids{remote_ids} {
+    auto const contains = [](std::vector<ProcId> const &ids, ProcId const id) {
+      return std::find(ids.begin(), ids.end(), id) != ids.end();
+    };
+    // Only the peers that may send us PKs get receive buffers: the signers,
+    // or also the verifiers if they relay.
+    auto const sends_pks = [&](ProcId const id) {
+      return contains(signer_ids, id) || (relay_fanout != 0 && contains(verifier_ids, id));
+    };
+    size_t nb_senders{0}, nb_verifiers{0};
+    for (auto const id : remote_ids) {
+      if (id < 0) throw std::runtime_error(fmt::format("Invalid remote id {}", id));
+      nb_senders += sends_pks(id);
+      nb_verifiers += contains(verifier_ids, id);
+    }
+    auto const armed_slots =
+        static_cast<size_t>(std::max(my_id, remote_ids.empty() ? my_id : *std::max_element(remote_ids.begin(), remote_ids.end()))) + 1;
+
+    // Where to send the batches of each signer, starting with ours.
+    auto signers = signer_ids;
+    if (!contains(signers, my_id)) signers.push_back(my_id);
+    RelayTree const relay{my_id, signers, verifier_ids, relay_fanout};
+    std::vector<ProcId> fanout;
+    for (auto const signer : signers) {
+      for (auto const id : relay.targets(signer)) {
+        if (contains(remote_ids, id) && !contains(fanout, id)) fanout.push_back(id);
+      }
+    }
+
+    auto [ce, ack_ce] = build_ces(my_id, remote_ids, cb, nb_senders, nb_verifiers, fanout.size(), armed_slots);
     auto const rdma_mr = cb.mr(namespaced("send-recv-mr"));
     std::pmr::monotonic_buffer_resource rdma_buffer{reinterpret_cast<void*>(rdma_mr.addr), rdma_mr.size};
     std::pmr::polymorphic_allocator<uint8_t> rdma_allocator{&rdma_buffer};
     for (auto &id : remote_ids) {
-      connections.try_emplace(id, my_id, id, ce.extract(id), ack_ce.extract(id), rdma_allocator, hw_credits);
+      auto const recv_credits = sends_pks(id) ? Connection::HardwareCredits : 0;
+      connections.try_emplace(id, my_id, id, ce.extract(id), ack_ce.extract(id), rdma_allocator, recv_credits, armed_slots);
+    }
+    // As each target holds at most `SendDepth` buffers, a buffer is free
+    // whenever one of them has room.
+    for (size_t i = 0; i < Connection::SendDepth * fanout.size(); i++) {
+      send_buffers.add(rdma_allocator.allocate(sizeof(Message)));
+    }
+
+    for (auto const signer : signers) {
+      auto &to = targets[signer];
+      for (auto const id : relay.targets(signer)) {
+        if (auto const it = connections.find(id); it != connections.end()) {
+          to.push_back(&it->second);
+        }
+      }
+    }
+    my_identities.push_back(my_id);
+    for (auto const &[identity, host] : identity_hosts) {
+      if (auto const it = targets.find(host); it != targets.end()) {
+        targets.emplace(identity, it->second);
+      }
+      if (host == my_id) my_identities.push_back(identity);
     }
   }
 
@@ -161,32 +315,142 @@ class Network {
       co.tick();
     }
     poll_send();
+    if (!pending.empty()) {
+      auto const start = std::chrono::steady_clock::now();
+      send_pending();
+      account(start, 0, 0);
+    }
   }
 
+  // Returns the signer of the received batch, which is not necessarily the
+  // process that sent it.
   // Note: we eschew a copy by returning a ref that is valid till next tick
   std::optional<std::pair<ProcId, std::reference_wrapper<BgPublicKeys::Compressed>>> poll_recv() {
-    wce.resize(1);
-    if (!cb.pollCqIsOk(recv_cq->get(), wce))
-      throw std::runtime_error("Polling error.");
-    if (wce.empty()) return std::nullopt;
-    auto &wc = wce.front();
-    if (wc.status != IBV_WC_SUCCESS)
-      throw std::runtime_error(fmt::format(
-        "Dsig RCs try_poll_recv. WC not successful ({}).", wc.status));
-    auto const [id, buf] = unpack(wc.wr_id);
-    connections.at(id).take_recv_buffer(buf);
-    return std::make_pair(id, std::ref(*reinterpret_cast<BgPublicKeys::Compressed*>(buf)));
+    while (true) {
+      wce.resize(1);
+      if (!cb.pollCqIsOk(recv_cq->get(), wce))
+        throw std::runtime_error("Polling error.");
+      if (wce.empty()) return std::nullopt;
+      auto &wc = wce.front();
+      if (wc.status != IBV_WC_SUCCESS)
+        throw std::runtime_error(fmt::format(
+          "Dsig RCs try_poll_recv. WC not successful ({}).", wc.status));
+      auto &co = *reinterpret_cast<Connection*>(wc.wr_id);
+      auto *const buf = co.recv_completed();
+      co.take_recv_buffer(buf);
+      auto &msg = *reinterpret_cast<Message*>(buf);
+      auto const to = targets.find(msg.signer);
+      if (unlikely(to == targets.end() || is_mine(msg.signer))) {
+        LOGGER_WARN(logger, "Dropping a batch of unknown signer {} from {}.", msg.signer, co.remoteId());
+        continue;
+      }
+      if (!seen.insert(msg.signer, compact_batch_id(msg.pks.root_sig))) {
+        LOGGER_DEBUG(logger, "Dropping a batch of {} seen already, from {}.", msg.signer, co.remoteId());
+        continue;
+      }
+      // Batches are forwarded before their root signature is checked so as not
+      // to delay the next hops, which check it anyway. Only new batches are,
+      // each hop holding at most `MaxLag` of them per target.
+      if (!to->second.empty()) {
+        auto const start = std::chrono::steady_clock::now();
+        enqueue(msg, to->second);
+        account(start, 0, 1);
+      }
+      return std::make_pair(msg.signer, std::ref(msg.pks));
+    }
   }
 
-  void send(BgPublicKeys::Compressed const& compressed) {
-    for (auto& [id, co] : connections) {
-      if (std::find(verifier_ids.begin(), verifier_ids.end(), id) == verifier_ids.end())
-        continue; // This process is not interrested in verifying signatures.
-      co.send(compressed);
-    }
+  // Sends a batch of `signer`, one of the identities of this process.
+  void send(BgPublicKeys::Compressed const& compressed, ProcId const signer) {
+    auto const &to = targets.at(signer);
+    if (to.empty()) return;
+    auto const start = std::chrono::steady_clock::now();
+    Message msg;
+    msg.signer = signer;
+    msg.pks = compressed;
+    enqueue(msg, to);
+    account(start, 1, 0);
+  }
+
+  // CPU spent by the background thread to send (or forward) batches.
+  SendStats send_stats() const {
+    return {sent_batches.load(std::memory_order_relaxed),
+            forwarded_batches.load(std::memory_order_relaxed),
+            send_cpu.load(std::memory_order_relaxed)};
   }
 
  private:
+  using Targets = std::vector<Connection*>;
+
+  bool is_mine(ProcId const signer) const {
+    return std::find(my_identities.begin(), my_identities.end(), signer) != my_identities.end();
+  }
+
+  void enqueue(Message const& msg, Targets const& to) {
+    // Batches are sent in order on each connection: once the older ones were
+    // given a chance, only the full connections still lag behind.
+    send_pending();
+    Targets lagging = to;
+    take_ready(lagging);
+    post(msg);
+    skip_overrun(lagging);
+    if (lagging.empty()) return;
+    for (auto *const co : lagging) co->fell_behind();
+    pending.push_back({msg, std::move(lagging)});
+  }
+
+  // Drops the connections that lag too far behind from `to`, so that `pending`
+  // holds at most `MaxLag` batches per target, forwarded ones included.
+  void skip_overrun(Targets &to) {
+    auto const overrun = std::partition(to.begin(), to.end(),
+                                        [](Connection const *co) { return !co->overrun(); });
+    for (auto it = overrun; it != to.end(); it++) {
+      if ((*it)->skip()) {
+        LOGGER_WARN(logger, "Process {} lags behind: skipping its batches until it catches up.",
+                    (*it)->remoteId());
+      }
+    }
+    to.erase(overrun, to.end());
+  }
+
+  void send_pending() {
+    // Posting only fills connections: one that is skipped for a batch is also
+    // skipped for the next ones.
+    for (auto it = pending.begin(); it != pending.end();) {
+      take_ready(it->to);
+      for (auto *const co : ready) co->caught_up();
+      post(it->msg);
+      it = it->to.empty() ? pending.erase(it) : std::next(it);
+    }
+  }
+
+  // Moves the targets that have room for one more buffer from `to` to `ready`.
+  void take_ready(Targets &to) {
+    auto const lagging = std::partition(to.begin(), to.end(),
+                                        [](Connection const *co) { return !co->full(); });
+    ready.assign(to.begin(), lagging);
+    to.erase(to.begin(), lagging);
+  }
+
+  // Posts `msg` to the `ready` targets from a single shared buffer.
+  void post(Message const& msg) {
+    if (ready.empty()) return;
+    auto *const buf = send_buffers.acquire(ready.size());
+    if (!buf) throw std::logic_error("No send buffer while a target has room.");
+    std::memcpy(buf, &msg, sizeof(msg));
+    for (auto *const co : ready) {
+      co->send(buf);
+    }
+  }
+
+  void account(std::chrono::steady_clock::time_point const start, size_t const batches,
+               size_t const forwarded) {
+    sent_batches.store(sent_batches.load(std::memory_order_relaxed) + batches, std::memory_order_relaxed);
+    forwarded_batches.store(forwarded_batches.load(std::memory_order_relaxed) + forwarded, std::memory_order_relaxed);
+    send_cpu.store(send_cpu.load(std::memory_order_relaxed) + (std::chrono::steady_clock::now() - start),
+                   std::memory_order_relaxed);
+  }
+
   void poll_send() {
     wce.resize(128);
     if (!cb.pollCqIsOk(send_cq->get(), wce))
@@ -195,35 +459,32 @@ class Network {
       if (wc.status != IBV_WC_SUCCESS)
         throw std::runtime_error(fmt::format(
             "Dsig RCs poll_send. WC not successful ({}).", wc.status));
-      auto const [id, buf] = unpack(wc.wr_id);
-      connections.at(id).take_send_buffer(buf);
+      send_buffers.release(reinterpret_cast<Connection*>(wc.wr_id)->send_completed());
     }
   }
 
-  static uint64_t pack(ProcId id, void *const buf) {
-    auto ptr = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(buf));
-    return (static_cast<uint64_t>(id) << 48) | ptr;
-  }
-
-  static std::pair<ProcId, void*> unpack(uint64_t const wr_id) {
-    auto const id = static_cast<ProcId>(wr_id >> 48);
-    auto const ptr = reinterpret_cast<void*>((wr_id << 16) >> 16);
-    return {id, ptr};
-  }
-
   std::pair<conn::RcConnectionExchanger<ProcId>, conn::RcConnectionExchanger<ProcId>> build_ces(
       ProcId my_id, std::vector<ProcId> const &remote_ids,
-      ctrl::ControlBlock &cb, size_t const hw_credits) {
+      ctrl::ControlBlock &cb, size_t const nb_senders, size_t const nb_verifiers,
+      size_t const nb_targets, size_t const armed_slots) {
+    // CQs are sized after the work requests that can be in flight at once.
+    auto const cq_depth = [](size_t const connections) {
+      return static_cast<int>(Connection::HardwareCredits * std::max(connections, 1ul));
+    };
+
     // Common
     cb.registerPd(namespaced("primary"));
 
     // Send/Recv
-    cb.allocateBuffer(namespaced("send-recv-buf"), sizeof(BgPublicKeys::Compressed) * hw_credits * 2 * remote_ids.size(), 64);
+    // Receive buffers per sender, send buffers shared by all the targets.
+    cb.allocateBuffer(namespaced("send-recv-buf"),
+                      sizeof(Message) * (Connection::HardwareCredits * nb_senders +
+                                         Connection::SendDepth * nb_targets), 64);
     cb.registerMr(
         namespaced("send-recv-mr"), namespaced("primary"), namespaced("send-recv-buf"),
         ctrl::ControlBlock::LOCAL_READ | ctrl::ControlBlock::LOCAL_WRITE);
-    cb.registerCq(namespaced("send-cq"));
-    cb.registerCq(namespaced("recv-cq"));
+    cb.registerCq(namespaced("send-cq"), cq_depth(nb_verifiers));
+    cb.registerCq(namespaced("recv-cq"), cq_depth(nb_senders));
     recv_cq = cb.cq(namespaced("recv-cq"));
     send_cq = cb.cq(namespaced("send-cq"));
     conn::RcConnectionExchanger<ProcId> ce(my_id, remote_ids, cb);
@@ -232,12 +493,12 @@ class Network {
     ce.announceAll(store, namespaced("qps"));
 
     // Ack - back pressure
-    cb.allocateBuffer(namespaced("ack-buf"), sizeof(Armed) * 2, 64);
+    cb.allocateBuffer(namespaced("ack-buf"), sizeof(size_t) * armed_slots * 2, 64);
     cb.registerMr(
         namespaced("ack-mr"), namespaced("primary"), namespaced("ack-buf"),
         ctrl::ControlBlock::LOCAL_READ | ctrl::ControlBlock::LOCAL_WRITE |
             ctrl::ControlBlock::REMOTE_READ | ctrl::ControlBlock::REMOTE_WRITE);
-    cb.registerCq(namespaced("ack-cq"));
+    cb.registerCq(namespaced("ack-cq"), cq_depth(remote_ids.size()));
     conn::RcConnectionExchanger<ProcId> ack_ce(my_id, remote_ids, cb);
     ack_ce.configureAll(namespaced("primary"), namespaced("ack-mr"),
                         namespaced("ack-cq"), namespaced("ack-cq"));
@@ -266,13 +527,31 @@ class Network {
   memstore::MemoryStore store;
 
   std::map<ProcId, Connection> connections;
+  std::map<ProcId, Targets> targets;
+  SharedSendBuffers send_buffers;
+  // Batches that some full targets did not take yet, oldest first.
+  struct Pending {
+    Message msg;
+    Targets to;
+  };
+  std::deque<Pending> pending;
+  // Targets of the batch being posted.
+  Targets ready;
+  std::atomic<size_t> sent_batches{0}, forwarded_batches{0};
+  std::atomic<std::chrono::nanoseconds> send_cpu{std::chrono::nanoseconds::zero()};
   std::optional<std::reference_wrapper<deleted_unique_ptr<struct ibv_cq>>> recv_cq, send_cq;
 
   std::vector<struct ibv_wc> wce;
 
+  ProcId my_id;
+  // Batches of these are ours: never accepted from the network.
+  std::vector<ProcId> my_identities;
+  // Enough for a batch to be seen again while cached, or while in the PK
+  // pipeline.
+  static size_t constexpr SeenWindow = 4 * CachedPkBatchesPerProcess;
+  SeenBatches seen{SeenWindow};
+
  public:
   std::vector<ProcId> remote_ids;
- private:
-  std::vector<ProcId> verifier_ids;
 };
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
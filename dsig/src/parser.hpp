@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <map>
+#include <optional>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -7,9 +9,10 @@
 #include <fmt/core.h>
 #include <toml.hpp>
 
+#include "export/namespace.hpp"
 #include "types.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 class RuntimeConfig {
  public:
@@ -68,6 +71,77 @@ class RuntimeConfig {
       fmt::print("[DSIG_CONFIG] No verifiers specified, assuming all processes verify.\n");
       verifier_ids = remote_ids;
     }
+
+    // Extra identities that processes sign as (e.g., one per tenant), keyed
+    // by their host, e.g., `1 = [101, 102]`. They share the background thread,
+    // the workers and the connections of their host.
+    if (toml::table* hosted = tbl["identities"].as_table()) {
+      for (auto&& [key, node] : *hosted) {
+        auto const host = static_cast<ProcId>(std::stoi(std::string(key.str())));
+        if (std::find(ids.begin(), ids.end(), host) == ids.end()) {
+          throw std::runtime_error(fmt::format(
+              "Unknown host {} of `identities` in the DSIG_CONFIG", host));
+        }
+        toml::array* arr = node.as_array();
+        if (!arr) {
+          throw std::runtime_error("`identities` must map hosts to arrays of ids in the DSIG_CONFIG");
+        }
+        for (auto const identity : parse_ids(arr)) {
+          if (std::find(ids.begin(), ids.end(), identity) != ids.end() ||
+              !identity_hosts.try_emplace(identity, host).second) {
+            throw std::runtime_error(fmt::format(
+                "Identity {} is not unique in the DSIG_CONFIG", identity));
+          }
+        }
+      }
+    }
+    my_identities.push_back(my_id);
+    remote_identities = remote_ids;
+    for (auto const& [identity, host] : identity_hosts) {
+      (host == my_id ? my_identities : remote_identities).push_back(identity);
+    }
+
+    if (auto const opt_workers = tbl["workers"].value<int64_t>()) {
+      if (*opt_workers < 0) {
+        throw std::runtime_error("`workers` cannot be negative in the DSIG_CONFIG");
+      }
+      nb_workers = static_cast<size_t>(*opt_workers);
+    }
+
+    // Bounds of the number of SKs kept ready, which adapts to the signing
+    // demand in between. By default, it is fixed to its maximum.
+    if (auto const opt_min = tbl["sk_depth_min"].value<int64_t>()) {
+      if (*opt_min <= 0) {
+        throw std::runtime_error("`sk_depth_min` must be positive in the DSIG_CONFIG");
+      }
+      sk_depth_min = static_cast<size_t>(*opt_min);
+    }
+    if (auto const opt_max = tbl["sk_depth_max"].value<int64_t>()) {
+      if (*opt_max <= 0) {
+        throw std::runtime_error("`sk_depth_max` must be positive in the DSIG_CONFIG");
+      }
+      sk_depth_max = static_cast<size_t>(*opt_max);
+    }
+    if (sk_depth_min > sk_depth_max) {
+      throw std::runtime_error("`sk_depth_min` exceeds `sk_depth_max` in the DSIG_CONFIG");
+    }
+
+    // Arity of the trees along which verifiers relay the PK batches (0: the
+    // signers send directly to all the verifiers).
+    if (auto const opt_fanout = tbl["relay_fanout"].value<int64_t>()) {
+      if (*opt_fanout < 0) {
+        throw std::runtime_error("`relay_fanout` cannot be negative in the DSIG_CONFIG");
+      }
+      fanout = static_cast<size_t>(*opt_fanout);
+    }
+
+    // File in which the unused SKs are kept across restarts, encrypted with
+    // the 32-byte key read from `snapshot_key`. Both are needed to enable it.
+    snapshot = tbl["snapshot"].value<std::string>();
+    snapshot_key = tbl["snapshot_key"].value<std::string>();
+    if (snapshot.has_value() != snapshot_key.has_value()) {
+      throw std::runtime_error("`snapshot` and `snapshot_key` go together in the DSIG_CONFIG");
+    }
   }
 
   std::string deviceName() const { return nic; }
@@ -77,6 +151,18 @@ class RuntimeConfig {
   std::vector<ProcId> const& remoteIds() { return remote_ids; }
   std::vector<ProcId> const& signerIds() { return signer_ids; }
   std::vector<ProcId> const& verifierIds() { return verifier_ids; }
+  // Identities this process signs as, starting with its id.
+  std::vector<ProcId> const& myIdentities() const { return my_identities; }
+  // Identities other processes sign as, including their ids.
+  std::vector<ProcId> const& remoteIdentities() const { return remote_identities; }
+  // Host of each extra identity.
+  std::map<ProcId, ProcId> const& identityHosts() const { return identity_hosts; }
+  size_t workers() const { return nb_workers; }
+  size_t relayFanout() const { return fanout; }
+  size_t skDepthMin() const { return sk_depth_min; }
+  size_t skDepthMax() const { return sk_depth_max; }
+  std::optional<std::string> const& snapshotPath() const { return snapshot; }
+  std::optional<std::string> const& snapshotKeyPath() const { return snapshot_key; }
 
  private:
   ProcId my_id;
@@ -84,7 +170,16 @@ class RuntimeConfig {
   std::vector<ProcId> remote_ids;
   std::vector<ProcId> signer_ids;
   std::vector<ProcId> verifier_ids;
+  std::map<ProcId, ProcId> identity_hosts;
+  std::vector<ProcId> my_identities;
+  std::vector<ProcId> remote_identities;
   std::string nic;
+  size_t nb_workers{0};
+  size_t fanout{0};
+  size_t sk_depth_min{PreparedSks};
+  size_t sk_depth_max{PreparedSks};
+  std::optional<std::string> snapshot;
+  std::optional<std::string> snapshot_key;
 
   bool contained_in(std::vector<ProcId> const& a, std::vector<ProcId> const& b) {
     for (auto const id : a) {
@@ -119,4 +214,4 @@ class RuntimeConfig {
   }
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -5,11 +5,23 @@
 #include <sstream>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 
+#include "export/namespace.hpp"
 #include "pinning.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
+
+// Threads that can be pinned: the scheduler (`bg`) and the workers (`worker<i>`)
+static bool is_pinnable(std::string const &name) {
+  if (name == "bg") return true;
+  std::string const worker_prefix{"worker"};
+  if (name.size() <= worker_prefix.size() ||
+      name.compare(0, worker_prefix.size(), worker_prefix) != 0) {
+    return false;
+  }
+  return std::all_of(name.begin() + static_cast<std::ptrdiff_t>(worker_prefix.size()),
+                     name.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
 
 // return (name,value) trimmed pair from given "name=value" string.
 // return empty string on missing parts
@@ -29,8 +41,7 @@ static inline std::pair<std::string, std::string> extract_kv(
     k = str.substr(0, n);
     v = str.substr(n + 1);
   }
-  std::unordered_set<std::string> threads = {{"bg"}};
-  if (threads.find(k) == threads.end()) {
+  if (!is_pinnable(k)) {
     throw std::runtime_error("Unknown thread " + k + " in env. DSIG_CORES");
   }
   return std::make_pair(k, v);
@@ -54,8 +65,7 @@ static inline std::unordered_map<std::string, std::string> extract_key_vals(
 }
 
 std::optional<int> get_core(std::string const &name) {
-  std::unordered_set<std::string> threads = {{"bg"}};
-  if (threads.find(name) == threads.end()) {
+  if (!is_pinnable(name)) {
     throw std::runtime_error("Unknown thread " + name + " upon get_core.");
   }
 
@@ -69,4 +79,4 @@ std::optional<int> get_core(std::string const &name) {
   return std::stoi(kvs_iter->second);
 }
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -3,7 +3,9 @@
 #include <optional>
 #include <string>
 
-namespace dory::dsig {
+#include "export/namespace.hpp"
+
+namespace dory::DSIG_NS {
 
 std::optional<int> get_core(std::string const& name);
 
@@ -1,68 +1,181 @@
 #pragma once
 
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <functional>
 
+#include <dory/shared/branching.hpp>
+
 #include "config.hpp"
+#include "export/namespace.hpp"
 #include "types.hpp"
 #include "pk/pk.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 // Thread-unsafe: must ensure exclusive access
 class PkCache {
   using UniquePks = std::unique_ptr<BgPublicKeys>;
   using OptionalPks = std::optional<std::reference_wrapper<BgPublicKeys>>;
+  using RootSig = BatchedInfSignature::InfSignature;
   struct Entry {
-    Entry(UniquePks&& pks): pks{std::move(pks)} {}
     size_t accessed{0};
     UniquePks pks;
+
+    size_t unused() const {
+      return accessed < BgPublicKeys::Size ? BgPublicKeys::Size - accessed : 0;
+    }
   };
-  std::deque<Entry> deque;
+
+  // Ring of the cached batches, from the oldest to the newest.
+  static size_t constexpr Capacity = CachedPkBatchesPerProcess;
+  std::array<Entry, Capacity> entries;
+  size_t oldest{0};
+  size_t count{0};
   size_t lookup_start{0};
-public:
-  size_t size() const { return deque.size(); }
+  // Sum of the unused PKs of the entries, kept up to date as they are looked up.
+  size_t unused{0};
 
-  UniquePks& back() {
-    return deque.back().pks;
-  }
+  Entry& at(size_t const i) { return entries[(oldest + i) % Capacity]; }
+  Entry const& at(size_t const i) const { return entries[(oldest + i) % Capacity]; }
 
-  void emplaceBack(UniquePks&& pks) {
-    if (deque.size() == CachedPkBatchesPerProcess) {
-      if (lookup_start > 0) lookup_start--;
-      deque.pop_front();
-    }
-    deque.emplace_back(std::move(pks));
+  // Open-addressed (linear probing) index from the root signatures to the
+  // entries. It is kept at most half full so that lookups take a single probe
+  // on average. Root signatures look random, so their first bytes are used as
+  // hash: the low bits give the bucket and the high bits the fingerprint.
+  struct Bucket {
+    uint32_t fingerprint;
+    uint16_t home;
+    uint16_t slot;
+  };
+  static_assert(sizeof(Bucket) == 8);
+  static size_t constexpr IndexSize = [] {
+    size_t size = 1;
+    while (size < 2 * Capacity) size <<= 1;
+    return size;
+  }();
+  static size_t constexpr IndexMask = IndexSize - 1;
+  static uint16_t constexpr EmptySlot = UINT16_MAX;
+  static_assert(IndexSize <= UINT16_MAX && Capacity < EmptySlot);
+  std::array<Bucket, IndexSize> index;
+
+  // The key is the batch id of compact signatures.
+  static uint64_t key(RootSig const& root_sig) {
+    return compact_batch_id(root_sig);
   }
 
-  OptionalPks associatedTo(Signature const &sig) {
-    for (size_t i = 0; i < deque.size(); i++) {
-      auto& entry = deque.at((lookup_start + i) % deque.size());
-      if (entry.pks->associatedTo(sig)) {
-        entry.accessed++;
-        if (entry.accessed == BgPublicKeys::Size)
-          lookup_start++;
-        return std::ref(*entry.pks);
+  template <typename Match>
+  std::optional<size_t> find(uint64_t const k, Match const& match) const {
+    auto const fingerprint = static_cast<uint32_t>(k >> 32);
+    for (auto pos = k & IndexMask; index[pos].slot != EmptySlot; pos = (pos + 1) & IndexMask) {
+      auto const& bucket = index[pos];
+      if (bucket.fingerprint == fingerprint && match(*entries[bucket.slot].pks)) {
+        return bucket.slot;
       }
     }
     return std::nullopt;
   }
 
-  size_t virgins() const {
-    size_t count{0};
-    for (auto& entry : deque) {
-      if (entry.accessed < BgPublicKeys::Size) {
-        count += BgPublicKeys::Size - entry.accessed;
+  std::optional<size_t> find(Signature const& sig) const {
+    // Fingerprints may collide: the full root signatures are compared.
+    return find(key(sig.pk_sig.root_sig),
+                [&sig](BgPublicKeys const& pks) { return pks.associatedTo(sig); });
+  }
+
+  std::optional<size_t> find(RootSig const& root_sig) const {
+    return find(key(root_sig),
+                [&root_sig](BgPublicKeys const& pks) { return pks.rootSig() == root_sig; });
+  }
+
+  std::optional<size_t> find(CompactSignature const& csig) const {
+    // Compact signatures only carry the key, which is compared in full.
+    return find(csig.batch_id, [&csig](BgPublicKeys const& pks) {
+      return key(pks.rootSig()) == csig.batch_id;
+    });
+  }
+
+  void indexSlot(size_t const slot) {
+    auto const k = key(entries[slot].pks->rootSig());
+    auto pos = k & IndexMask;
+    while (index[pos].slot != EmptySlot) pos = (pos + 1) & IndexMask;
+    index[pos] = {static_cast<uint32_t>(k >> 32), static_cast<uint16_t>(k & IndexMask),
+                  static_cast<uint16_t>(slot)};
+  }
+
+  void unindexSlot(size_t const slot) {
+    auto pos = key(entries[slot].pks->rootSig()) & IndexMask;
+    while (index[pos].slot != slot) pos = (pos + 1) & IndexMask;
+    // Backward-shift deletion: buckets of the cluster that cannot be reached
+    // from their home anymore are moved into the hole.
+    index[pos].slot = EmptySlot;
+    for (auto next = (pos + 1) & IndexMask; index[next].slot != EmptySlot; next = (next + 1) & IndexMask) {
+      if (((next - index[next].home) & IndexMask) >= ((next - pos) & IndexMask)) {
+        index[pos] = index[next];
+        index[next].slot = EmptySlot;
+        pos = next;
       }
     }
-    return count;
   }
 
+public:
+  PkCache() {
+    for (auto& bucket : index) bucket.slot = EmptySlot;
+  }
+
+  size_t size() const { return count; }
+
+  UniquePks& back() {
+    return at(count - 1).pks;
+  }
+
+  // Returns the evicted batch, if any, so that it can be freed without holding
+  // the lock of the cache. A batch whose root signature is cached already is
+  // not inserted again (e.g., replayed by a relay): it is returned instead.
+  UniquePks emplaceBack(UniquePks&& pks) {
+    if (unlikely(find(pks->rootSig()))) return std::move(pks);
+    UniquePks evicted;
+    if (count == Capacity) {
+      if (lookup_start > 0) lookup_start--;
+      unindexSlot(oldest);
+      unused -= entries[oldest].unused();
+      evicted = std::move(entries[oldest].pks);
+      entries[oldest] = Entry{};
+      oldest = (oldest + 1) % Capacity;
+      count--;
+    }
+    auto const slot = (oldest + count) % Capacity;
+    entries[slot] = Entry{0, std::move(pks)};
+    count++;
+    unused += BgPublicKeys::Size;
+    indexSlot(slot);
+    return evicted;
+  }
+
+  // `uses` is the number of signatures that will be verified with the PKs.
+  template <typename Sig>
+  OptionalPks associatedTo(Sig const &sig, size_t const uses = 1) {
+    auto const slot = find(sig);
+    if (unlikely(!slot)) return std::nullopt;
+    auto& entry = entries[*slot];
+    auto const was_exhausted = entry.accessed >= BgPublicKeys::Size;
+    unused -= entry.unused();
+    entry.accessed += uses;
+    unused += entry.unused();
+    if (!was_exhausted && entry.accessed >= BgPublicKeys::Size)
+      lookup_start++;
+    return std::ref(*entry.pks);
+  }
+
+  size_t virgins() const { return unused; }
+
+  // Prefetches the batch that the next signature is the most likely to use.
   void prefetch() {
-    if (deque.empty()) return;
-    auto &entry = deque.at(lookup_start % deque.size());
+    if (count == 0) return;
+    auto &entry = at(lookup_start % count);
     entry.pks->prefetch();
     if constexpr (HbssScheme == HorsMerkle) {
       if (entry.accessed < BgPublicKeys::Size) {
@@ -70,5 +183,18 @@ public:
       }
     }
   }
+
+  // Prefetches exactly what is needed to verify `sig`.
+  void prefetch(Signature const &sig) {
+    auto const slot = find(sig);
+    if (!slot) return;
+    auto& pks = *entries[*slot].pks;
+    pks.prefetch();
+    if constexpr (HbssScheme == HorsMerkle) {
+      if (sig.pk_sig.index < BgPublicKeys::Size) {
+        pks.prefetch_hors_tree(sig.pk_sig.index);
+      }
+    }
+  }
 };
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
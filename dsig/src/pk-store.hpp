@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "export/namespace.hpp"
+#include "mutex.hpp"
+#include "pk-cache.hpp"
+#include "types.hpp"
+
+namespace dory::DSIG_NS {
+
+struct alignas(64) PkShard {
+  Mutex mutex;
+  PkCache cache;
+  // How the verifications of the signer's signatures ended.
+  std::atomic<uint64_t> fast{0}, waited{0}, slow{0};
+  // Batches published so far, so that pending verifications are only retried
+  // once new PKs arrived.
+  std::atomic<uint64_t> arrivals{0};
+};
+
+/**
+ * @brief Verified PKs of the remote processes, sharded per signer.
+ *
+ * Each signer has its own cache and lock: publishing the PKs of a signer never
+ * blocks the verification of the signatures of another one. Shards are
+ * indexed by ProcId and are never added nor removed after construction, so
+ * looking one up does not require any lock.
+ */
+class PkStore {
+ public:
+  PkStore(std::vector<ProcId> const &ids) {
+    if (ids.empty()) return;
+    auto const max_id = *std::max_element(ids.begin(), ids.end());
+    shards.resize(static_cast<size_t>(max_id) + 1);
+    for (auto const id : ids) {
+      shards.at(static_cast<size_t>(id)) = std::make_unique<PkShard>();
+    }
+  }
+
+  PkShard &at(ProcId const pid) {
+    auto const idx = static_cast<size_t>(pid);
+    if (unlikely(pid < 0 || idx >= shards.size() || !shards[idx])) {
+      throw std::out_of_range(fmt::format("No PKs for process {}.", pid));
+    }
+    return *shards[idx];
+  }
+
+  VerifyStats stats() const {
+    VerifyStats total{0, 0, 0};
+    for (auto const &shard : shards) {
+      if (!shard) continue;
+      total.fast += shard->fast.load(std::memory_order_relaxed);
+      total.waited += shard->waited.load(std::memory_order_relaxed);
+      total.slow += shard->slow.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+ private:
+  std::vector<std::unique_ptr<PkShard>> shards;
+};
+
+}  // namespace dory::DSIG_NS
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "../config.hpp"
+#include "../export/namespace.hpp"
+#include "../types.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Ranks the signers by how soon they will run out of PKs.
+ *
+ * Every `Period`, the scheduler reports, for each signer, how many of its
+ * signatures were verified so far and how many of its cached PKs are unused.
+ * The tracker averages the verification rate of each signer and derives its
+ * slack: the number of periods its unused PKs, plus those of its batches being
+ * processed, last at this rate. Signers with the least slack come first.
+ *
+ * Slacks are capped at `Horizon` so that the signers that are idle or have
+ * PKs to spare are ranked by how many PKs they have: each of them gets a batch
+ * before any gets a second one.
+ */
+class PkDemand {
+ public:
+  using Clock = std::chrono::steady_clock;
+  // Lower is more urgent: the capped slack, then the number of PKs.
+  using Priority = std::pair<double, size_t>;
+
+  PkDemand(std::vector<ProcId> const &ids) {
+    for (auto const id : ids) signers.try_emplace(id);
+  }
+
+  /**
+   * @brief Whether a new `Period` started, i.e., whether to report.
+   */
+  bool due(Clock::time_point const now) {
+    if (now < next_update) return false;
+    next_update = now + Period;
+    return true;
+  }
+
+  /**
+   * @brief Accounts for the verifications of `id` so far (monotonic count)
+   *        and for its cached PKs that are still unused.
+   */
+  void update(ProcId const id, uint64_t const verified, size_t const unused) {
+    auto &signer = signers.at(id);
+    auto const delta = static_cast<double>(verified - signer.last_verified);
+    signer.last_verified = verified;
+    signer.rate = signer.rate * (1 - RateSmoothing) + delta * RateSmoothing;
+    signer.unused = unused;
+  }
+
+  /**
+   * @brief Accounts for a batch of `id` handed over to its cache since the
+   *        last report.
+   */
+  void delivered(ProcId const id) { signers.at(id).unused += InfBatchSize; }
+
+  /**
+   * @brief Priority of `id`, given its `incoming` batches being processed.
+   */
+  Priority priority(ProcId const id, size_t const incoming) const {
+    auto const &signer = signers.at(id);
+    auto const supply = signer.unused + incoming * InfBatchSize;
+    auto const slack = signer.rate > 0 ? static_cast<double>(supply) / signer.rate
+                                       : Horizon;
+    return {std::min(slack, Horizon), supply};
+  }
+
+ private:
+  static constexpr Clock::duration Period = std::chrono::milliseconds(1);
+  // Exponential average over ~20 periods.
+  static constexpr double RateSmoothing = 0.05;
+  // Signers with PKs for more than ~1s are not urgent.
+  static constexpr double Horizon = 1000;
+
+  struct Signer {
+    uint64_t last_verified{0};
+    double rate{0};
+    size_t unused{0};
+  };
+  std::map<ProcId, Signer> signers;
+
+  Clock::time_point next_update{};
+};
+
+}  // namespace dory::DSIG_NS
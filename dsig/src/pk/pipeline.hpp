@@ -1,28 +1,50 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <deque>
 #include <exception>
+#include <functional>
 #include <map>
 #include <memory>
+#include <queue>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <dory/shared/logger.hpp>
 
 #include "../config.hpp"
+#include "../export/namespace.hpp"
 #include "../network.hpp"
 #include "../types.hpp"
 #include "../mutex.hpp"
 #include "../workers.hpp"
+#include "demand.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
+/**
+ * @brief Turns the received PK batches into ready ones: computes their trees
+ *        and checks their root signatures on the workers.
+ *
+ * Batches are not processed in arrival order but by urgency (see `PkDemand`):
+ * the signers whose PKs are about to run out go first, so that a chatty signer
+ * cannot delay the others. Only enough trees to keep the workers busy are
+ * computed at once, the other batches wait in `received_pks`.
+ */
 class PkPipeline {
  public:
-  PkPipeline(Network &net, InfCrypto &inf, Workers& workers)
-      : inf_crypto{inf}, net{net}, workers{workers} {
-    for (auto const &id : net.remote_ids) {
+  // `ids` are the signers (remote identities) whose batches are processed.
+  PkPipeline(Network &net, InfCrypto &inf, Workers& workers,
+             std::vector<ProcId> const &ids)
+      : demand{ids},
+        max_computing{std::max<size_t>(1, 2 * workers.size())},
+        inf_crypto{inf}, net{net}, workers{workers} {
+    for (auto const &id : ids) {
+      received_pks.try_emplace(id);
       wip_pks.try_emplace(id);
-      ready_pks.try_emplace(id);
     }
   }
 
@@ -33,41 +55,151 @@ class PkPipeline {
 
   void tick() {
     poll_recv_pks();
+    start_computations();
+    check_root_sigs();
     put_ready_pks_aside();
   }
 
+  // Batches are extracted in the order they got ready.
   std::optional<std::pair<ProcId, std::unique_ptr<BgPublicKeys>>> extract_ready() {
     std::scoped_lock<Mutex> lock{ready_pks_mutex};
-    for (auto &[id, queue] : ready_pks) {
-      if (!queue.empty()) {
-        auto bg_pks = std::move(queue.front());
-        queue.pop_front();
-        return std::make_pair(id, std::move(bg_pks));
-      }
-    }
-    return std::nullopt;
+    if (ready_pks.empty()) return std::nullopt;
+    auto id_pks = std::move(ready_pks.front());
+    ready_pks.pop_front();
+    return id_pks;
   }
 
+  // Fed by the scheduling thread with the verifications and unused PKs.
+  PkDemand demand;
+
+  // Batches received so far.
+  uint64_t received() const { return arrivals; }
+
  private:
+  // Batches are copied out of the receive buffers, their trees are computed
+  // later on.
   void poll_recv_pks() {
     while (auto opt_id_pks = net.poll_recv()) {
       auto const& [id, pks] = *opt_id_pks;
-      wip_pks.at(id).emplace_back(std::make_unique<BgPublicKeys>(workers, inf_crypto, id, pks.get()));
+      received_pks.at(id).push_back(
+          {arrivals++, std::make_unique<BgPublicKeys>(pks.get())});
+    }
+  }
+
+  // Starts computing the trees of the most urgent signers first, their oldest
+  // batch first. Equally urgent signers are served in arrival order.
+  void start_computations() {
+    // Trees are computed until the batch is `Computed`, or `Invalid` if it
+    // failed.
+    size_t computing = 0;
+    for (auto const &[_, queue] : wip_pks) {
+      for (auto const &pks : queue) {
+        computing += pks->state.load() == BgPublicKeys::State::Initializing;
+      }
+    }
+    if (computing >= max_computing) return;
+    using Candidate = std::tuple<PkDemand::Priority, uint64_t, ProcId>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;
+    auto const candidate = [this](ProcId const id) {
+      return Candidate{demand.priority(id, wip_pks.at(id).size()),
+                       received_pks.at(id).front().arrival, id};
+    };
+    for (auto const &[id, queue] : received_pks) {
+      if (!queue.empty()) candidates.push(candidate(id));
+    }
+    while (computing < max_computing && !candidates.empty()) {
+      auto const id = std::get<ProcId>(candidates.top());
+      candidates.pop();
+      auto &queue = received_pks.at(id);
+      auto &pks = wip_pks.at(id).emplace_back(std::move(queue.front().pks));
+      queue.pop_front();
+      pks->compute(workers);
+      computing++;
+      if (!queue.empty()) candidates.push(candidate(id));
     }
   }
 
+  // Batches whose trees are computed, from all the signers, have their root
+  // signatures checked by groups: the more arrive together (e.g., at startup
+  // or in bursts), the cheaper each check. The most urgent signers are
+  // checked first.
+  void check_root_sigs() {
+    std::vector<std::pair<PkDemand::Priority, ProcId>> computed;
+    for (auto &[id, queue] : wip_pks) {
+      for (auto &pks : queue) {
+        if (pks->state.load() != BgPublicKeys::State::Computed) continue;
+        computed.emplace_back(demand.priority(id, queue.size()), id);
+        break;
+      }
+    }
+    std::sort(computed.begin(), computed.end());
+
+    RootSigGroup group;
+    for (auto const &[_, id] : computed) {
+      for (auto &pks : wip_pks.at(id)) {
+        if (pks->state.load() != BgPublicKeys::State::Computed) continue;
+        pks->state = BgPublicKeys::State::Checking;
+        group.batches[group.size] = pks.get();
+        group.srcs[group.size] = id;
+        if (++group.size == group.batches.size()) {
+          schedule(group);
+          group.size = 0;
+        }
+      }
+    }
+    if (group.size != 0) schedule(group);
+  }
+
+  struct RootSigGroup {
+    std::array<BgPublicKeys *, BgPublicKeys::RootSigGroup> batches;
+    std::array<ProcId, BgPublicKeys::RootSigGroup> srcs;
+    size_t size = 0;
+  };
+
+  // Batches outlive the check as they stay in `wip_pks` until `Ready`. If the
+  // check throws, none of them got a verdict: they are all dropped.
+  void schedule(RootSigGroup const &group) {
+    workers.schedule(
+        [this, group] {
+          BgPublicKeys::check_root_sigs(inf_crypto, group.batches.data(),
+                                        group.srcs.data(), group.size);
+        },
+        [group](std::exception_ptr) {
+          for (size_t i = 0; i < group.size; i++) {
+            group.batches[i]->state = BgPublicKeys::State::Invalid;
+          }
+        });
+  }
+
   void put_ready_pks_aside() {
     for (auto &[id, queue] : wip_pks) {
-      while (!queue.empty() && queue.front()->state == BgPublicKeys::State::Ready) {
+      while (!queue.empty()) {
+        auto const state = queue.front()->state.load();
+        if (state == BgPublicKeys::State::Invalid) {
+          LOGGER_WARN(logger, "Dropping an invalid batch of {}.", id);
+          queue.pop_front();
+          continue;
+        }
+        if (state != BgPublicKeys::State::Ready) break;
+        demand.delivered(id);
         std::scoped_lock<Mutex> lock{ready_pks_mutex};
-        ready_pks.at(id).push_back(std::move(queue.front()));
+        ready_pks.emplace_back(id, std::move(queue.front()));
         queue.pop_front();
       }
     }
   }
 
+  struct Received {
+    uint64_t arrival;
+    std::unique_ptr<BgPublicKeys> pks;
+  };
+  std::map<ProcId, std::deque<Received>> received_pks;
+  uint64_t arrivals{0};
+  // Batches whose trees are computed at once.
+  size_t const max_computing;
+
   std::map<ProcId, std::deque<std::unique_ptr<BgPublicKeys>>> wip_pks;
-  std::map<ProcId, std::deque<std::unique_ptr<BgPublicKeys>>> ready_pks;
+  std::deque<std::pair<ProcId, std::unique_ptr<BgPublicKeys>>> ready_pks;
   Mutex ready_pks_mutex;
 
   InfCrypto& inf_crypto;
@@ -77,4 +209,4 @@ class PkPipeline {
   LOGGER_DECL_INIT(logger, "Dsig::PkPipeline");
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
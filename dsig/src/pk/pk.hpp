@@ -1,21 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <exception>
 
+#include "../export/namespace.hpp"
 #include "../inf-crypto/batch.hpp"
 #include "../merkle.hpp"
+#include "../message.hpp"
+#include "../slab.hpp"
 #include "../types.hpp"
 #include "../workers.hpp"
 
 #include "../hors.hpp"
 #include "../wots.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
-class BgPublicKeys {
+// Recycled through a slab, as is the storage of its HORS trees.
+class BgPublicKeys: public SlabAllocated<BgPublicKeys> {
 public:
   static size_t constexpr Size = InfBatchSize;
+  // Number of signatures whose HBSS is checked together by `verify_many`.
+  static size_t constexpr VerifyGroup = 16;
+  // Number of root signatures checked together by `check_root_sigs`.
+  static size_t constexpr RootSigGroup = 64;
 
   struct Compressed {
     BatchMerkleTree::Leaves pk_hashes;
@@ -25,15 +35,20 @@ public:
     #endif
   };
 
+  // Batches go through `Computed` and `Checking` until the root signatures
+  // of several of them are checked at once.
   enum State {
     Initializing,
+    Computed,
+    Checking,
     Ready,
     Invalid,
     LAST_STATE = Ready
   };
   std::atomic<State> state{Initializing};
 
-  BgPublicKeys(Workers& workers, InfCrypto& inf_crypto, ProcId const src, Compressed const& compressed):
+  // The trees are only computed once `compute` is called.
+  BgPublicKeys(Compressed const& compressed):
     tree{compressed.pk_hashes, false}, root_sig{compressed.root_sig} {
     #if HBSS_SCHEME == HORS_MERKLE
     hors_pk_trees.reserve(InfBatchSize);
@@ -41,13 +56,28 @@ public:
       hors_pk_trees.emplace_back(pk_leaves, false);
     }
     #endif
-    workers.schedule([this, &inf_crypto, src]{
-      tree.compute();
-      if constexpr (HbssScheme == HorsMerkle) {
-        compute_hors_pk_trees();
-      }
-      check_root_sig(inf_crypto, src);
-    });
+  }
+
+  BgPublicKeys(Workers& workers, Compressed const& compressed):
+    BgPublicKeys{compressed} {
+    compute(workers);
+  }
+
+  // Computes the trees on the workers, then moves to `Computed` (or to
+  // `Invalid` if it failed).
+  void compute(Workers& workers) {
+    workers.schedule(
+        [this] {
+          tree.compute();
+          if constexpr (HbssScheme == HorsMerkle) {
+            compute_hors_pk_trees();
+          }
+          state = Computed;
+        },
+        [this](std::exception_ptr) {
+          fmt::print(stderr, "Could not compute the trees of a bg pk batch!\n");
+          state = Invalid;
+        });
   }
 
   BgPublicKeys(BgPublicKeys const&) = delete;
@@ -59,14 +89,13 @@ public:
    * @brief Verify if a signature is valid.
    *
    */
-  bool verify(Signature const& sig, uint8_t const* msg,
-              size_t const msg_len) const {
+  bool verify(Signature const& sig, MsgView const& msg) const {
     if (!verifyPkSig(sig.pk_sig)) {
       fmt::print(stderr, "Invalid PK sig!\n");
       return false;
     }
 
-    if (!verifyHbss(sig, msg, msg + msg_len)) {
+    if (!verifyHbss(sig, msg)) {
       fmt::print(stderr, "Invalid HBSS!\n");
       return false;
     }
@@ -74,16 +103,93 @@ public:
     return true;
   }
 
-  bool associatedTo(Signature const &sig) {
+  /**
+   * @brief Verifies `nb` signatures associated to this batch.
+   *
+   * `valid[idxs[i]]` receives the validity of `reqs[idxs[i]]`. The root
+   * signature is compared once for all of them. The signatures whose PK is in
+   * the batch then have their HBSS checked by groups of up to `VerifyGroup`.
+   */
+  void verify_many(VerifyRequest const* const reqs, size_t const* const idxs,
+                   size_t const nb, bool* const valid) const {
+    if (nb == 0) return;
+    auto const root_matches = matchesRootSig(reqs[idxs[0]].sig->pk_sig);
+    for (size_t done = 0; done < nb; done += VerifyGroup) {
+      auto const group = std::min(VerifyGroup, nb - done);
+      std::array<Signature const*, VerifyGroup> sigs;
+      std::array<MsgView, VerifyGroup> msgs;
+      std::array<size_t, VerifyGroup> checked;
+      std::array<bool, VerifyGroup> hbss_ok;
+      size_t nb_checked = 0;
+      for (size_t i = 0; i < group; i++) {
+        auto const idx = idxs[done + i];
+        auto const& req = reqs[idx];
+        // Signatures whose PK is not in the batch are left out of the group.
+        if (!root_matches || !inBatch(req.sig->pk_sig)) {
+          fmt::print(stderr, "Invalid signature in batched verification!\n");
+          valid[idx] = false;
+          continue;
+        }
+        sigs[nb_checked] = req.sig;
+        msgs[nb_checked] = MsgView(req.m, req.mlen);
+        checked[nb_checked++] = idx;
+      }
+      verifyHbssGroup(sigs.data(), msgs.data(), hbss_ok.data(), nb_checked);
+      for (size_t i = 0; i < nb_checked; i++) {
+        if (!hbss_ok[i]) {
+          fmt::print(stderr, "Invalid signature in batched verification!\n");
+        }
+        valid[checked[i]] = hbss_ok[i];
+      }
+    }
+  }
+
+  bool associatedTo(Signature const &sig) const {
     return std::memcmp(&sig.pk_sig.root_sig, &root_sig, sizeof(root_sig)) == 0;
   }
 
+  BatchedInfSignature::InfSignature const& rootSig() const { return root_sig; }
+
+  // Rebuilds the batched Inf signature of the `index`-th PK of the batch.
+  BatchedInfSignature pkSig(size_t const index) const {
+    return BatchedInfSignature{tree.leaves().at(index), tree, index, root_sig};
+  }
+
   void prefetch() {
-    dsig::prefetch(*this);
+    DSIG_NS::prefetch(*this);
   }
 
   void prefetch_hors_tree(size_t const pk_idx) {
-    dsig::prefetch(hors_pk_trees.at(pk_idx));
+    DSIG_NS::prefetch(hors_pk_trees.at(pk_idx));
+  }
+
+  /**
+   * @brief Checks the root signatures of `n` `Computed` batches, `srcs[i]`
+   *        being the signer of `batches[i]`, which become `Ready` or `Invalid`.
+   *
+   * Signatures are verified by groups of `RootSigGroup`, which EdDSA batch
+   * verification makes several times cheaper than one by one.
+   */
+  static void check_root_sigs(InfCrypto& inf_crypto, BgPublicKeys* const* batches,
+                              ProcId const* srcs, size_t const n) {
+    std::array<BatchedInfSignature::InfSignature const*, RootSigGroup> sigs;
+    std::array<uint8_t const*, RootSigGroup> roots;
+    std::array<size_t, RootSigGroup> lens;
+    std::array<bool, RootSigGroup> valid;
+    for (size_t done = 0; done < n; done += RootSigGroup) {
+      auto const group = std::min(RootSigGroup, n - done);
+      for (size_t i = 0; i < group; i++) {
+        auto const& pks = *batches[done + i];
+        sigs[i] = &pks.root_sig;
+        roots[i] = reinterpret_cast<uint8_t const*>(pks.tree.root().data());
+        lens[i] = pks.tree.root().size();
+      }
+      inf_crypto.verify_many(sigs.data(), roots.data(), lens.data(), srcs + done,
+                             group, valid.data());
+      for (size_t i = 0; i < group; i++) {
+        batches[done + i]->root_sig_checked(valid[i], srcs[done + i]);
+      }
+    }
   }
 
 private:
@@ -93,31 +199,87 @@ private:
     }
   }
 
-  void check_root_sig(InfCrypto& inf_crypto, ProcId const src) {
-    if (!inf_crypto.verify(root_sig, reinterpret_cast<uint8_t const*>(tree.root().data()), tree.root().size(), src)) {
+  void root_sig_checked(bool const valid, ProcId const src) {
+    if (!valid) {
+      // Batches may be relayed by other processes: a forged one is dropped
+      // rather than taken down the worker.
+      fmt::print(stderr, "Invalid bg pk signature from {}!\n", src);
       state = Invalid;
-      throw std::runtime_error("Invalid bg pk signature!");
+      return;
     }
     state = Ready;
   }
 
   bool verifyPkSig(BatchedInfSignature const& pk_sig) const {
+    return matchesRootSig(pk_sig) && inBatch(pk_sig);
+  }
+
+  bool matchesRootSig(BatchedInfSignature const& pk_sig) const {
     if (std::memcmp(&pk_sig.root_sig, &root_sig, sizeof(root_sig)) != 0) {
       fmt::print(stderr, "Pk root sig does not match: {} vs {}!\n",
         pk_sig.root_sig, root_sig);
       return false;
     }
+    return true;
+  }
 
+  bool inBatch(BatchedInfSignature const& pk_sig) const {
+    if (pk_sig.index >= Size) {
+      fmt::print(stderr, "Pk index {} out of the batch!\n", pk_sig.index);
+      return false;
+    }
     if (!pk_sig.proof.in_tree(pk_sig.signed_hash, pk_sig.index, tree)) {
       fmt::print(stderr, "Pk element and proof not found in precomputed tree!\n");
       return false;
     }
-
     return true;
   }
 
-  bool verifyHbss(HorsMerkleSignature const& sig, uint8_t const* const begin,
-                  uint8_t const* const end) const {
+  template <typename S>
+  void verifyHbssGroup(S const* const* sigs, MsgView const* msgs,
+                       bool* const ok, size_t const nb) const {
+    for (size_t i = 0; i < nb; i++) {
+      ok[i] = verifyHbss(*sigs[i], msgs[i]);
+    }
+  }
+
+  // The chains of all the signatures are advanced together, level by level,
+  // so that independent hashes are issued back to back.
+  void verifyHbssGroup(WotsSignature const* const* sigs, MsgView const* msgs,
+                       bool* const ok, size_t const nb) const {
+    std::array<decltype(WotsSignature::secrets), VerifyGroup> sig_hashes;
+    std::array<std::array<uint8_t, wots::SecretsPerSignature>, VerifyGroup> depths;
+    for (size_t i = 0; i < nb; i++) {
+      auto const& sig = *sigs[i];
+      sig_hashes[i] = sig.secrets;
+      WotsHash h(tree.leaves().at(sig.pk_sig.index), sig.nonce, msgs[i]);
+      for (size_t secret = 0; secret < wots::SecretsPerSignature; secret++) {
+        depths[i][secret] = h.getSecretDepth(secret);
+      }
+    }
+
+    SecretHasher secret_hasher;
+    for (size_t d = 0; d + 1 < SecretsDepth; d++) {
+      for (size_t i = 0; i < nb; i++) {
+        for (size_t secret = 0; secret < wots::SecretsPerSignature; secret++) {
+          if (depths[i][secret] <= d) {
+            secret_hasher.push(sig_hashes[i][secret], sigs[i]->pk_nonce, secret, d, sig_hashes[i][secret]);
+          }
+        }
+      }
+      secret_hasher.flush();
+    }
+
+    for (size_t i = 0; i < nb; i++) {
+      auto const& exp_pk_hash = tree.leaves().at(sigs[i]->pk_sig.index);
+      auto hasher = crypto::hash::blake3_init();
+      crypto::hash::blake3_update(hasher, sigs[i]->pk_nonce);
+      crypto::hash::blake3_update(hasher, sig_hashes[i]);
+      ok[i] = std::memcmp(crypto::hash::blake3_final(hasher).data(), exp_pk_hash.data(), exp_pk_hash.size()) == 0;
+    }
+  }
+
+  bool verifyHbss(HorsMerkleSignature const& sig, MsgView const& msg) const {
     auto const pk_idx = sig.pk_sig.index;
     auto const& exp_pk_hash = tree.leaves().at(pk_idx);
     // 1. Verify that the roots match the tree
@@ -127,10 +289,16 @@ private:
       return false;
     }
     // 2. For each secret, verify it is part of the tree
-    HorsHash h(exp_pk_hash, sig.nonce, begin, end);
+    HorsHash h(exp_pk_hash, sig.nonce, msg);
+    std::array<SecretHash, hors::SecretsPerSignature> hashed_secrets;
+    SecretHasher secret_hasher;
+    for (size_t secret = 0; secret < hors::SecretsPerSignature; secret++) {
+      secret_hasher.push(sig.secretsAndNeighborsHash.at(secret).secret, sig.pk_nonce, h.getSecretIndex(secret), 0, hashed_secrets[secret]);
+    }
+    secret_hasher.flush();
     for (size_t secret = 0; secret < hors::SecretsPerSignature; secret++) {
       auto const secret_index = h.getSecretIndex(secret);
-      auto const hashed_secret = hash_secret(sig.secretsAndNeighborsHash.at(secret).secret, sig.pk_nonce, secret_index);
+      auto const& hashed_secret = hashed_secrets[secret];
       auto const neighbor_hashed_secret = sig.secretsAndNeighborsHash.at(secret).neighborHash;
       std::array<SecretHash, 2> leaf;
       if(secret_index & 1){
@@ -155,17 +323,18 @@ private:
     return true;
   }
 
-  bool verifyHbss(HorsCompletedSignature const& sig, uint8_t const* const begin,
-                  uint8_t const* const end) const {
+  bool verifyHbss(HorsCompletedSignature const& sig, MsgView const& msg) const {
     auto sig_hashes = sig.fused_secrets;
     auto const& exp_pk_hash = tree.leaves().at(sig.pk_sig.index);
 
-    HorsHash h(exp_pk_hash, sig.nonce, begin, end);
+    HorsHash h(exp_pk_hash, sig.nonce, msg);
 
+    SecretHasher secret_hasher;
     for (size_t secret = 0; secret < hors::SecretsPerSignature; secret++) {
       auto const secret_index = h.getSecretIndex(secret);
-      sig_hashes.at(secret_index) = hash_secret(sig.fused_secrets.at(secret_index), sig.pk_nonce, secret_index);
+      secret_hasher.push(sig.fused_secrets.at(secret_index), sig.pk_nonce, secret_index, 0, sig_hashes.at(secret_index));
     }
+    secret_hasher.flush();
 
     auto hasher = crypto::hash::blake3_init();
     crypto::hash::blake3_update(hasher, sig.pk_nonce);
@@ -173,20 +342,21 @@ private:
     return std::memcmp(crypto::hash::blake3_final(hasher).data(), exp_pk_hash.data(), exp_pk_hash.size()) == 0;
   }
 
-  bool verifyHbss(WotsSignature const& sig, uint8_t const* const begin,
-                  uint8_t const* const end) const {
+  bool verifyHbss(WotsSignature const& sig, MsgView const& msg) const {
     auto sig_hashes = sig.secrets;
     auto const& exp_pk_hash = tree.leaves().at(sig.pk_sig.index);
 
-    WotsHash h(exp_pk_hash, sig.nonce, begin, end);
+    WotsHash h(exp_pk_hash, sig.nonce, msg);
 
-    for (size_t secret = 0; secret < wots::SecretsPerSignature; secret++) {
-      // fmt::print("Secret {} has depth {}: {}\n", secret, h.getSecretDepth(secret), sig_hashes[secret]);
-      for (size_t d = h.getSecretDepth(secret); d + 1 < SecretsDepth; d++) {
-        // fmt::print("Hashing secret {} (l={}), {} -> {}\n", secret, d, sig_hashes[secret], hash_secret(sig_hashes[secret], sig.pk_nonce, secret, d));
-        sig_hashes[secret] = hash_secret(sig_hashes[secret], sig.pk_nonce, secret, d);
+    // Chains are completed level by level so that their hashes fill the lanes.
+    SecretHasher secret_hasher;
+    for (size_t d = 0; d + 1 < SecretsDepth; d++) {
+      for (size_t secret = 0; secret < wots::SecretsPerSignature; secret++) {
+        if (h.getSecretDepth(secret) <= d) {
+          secret_hasher.push(sig_hashes[secret], sig.pk_nonce, secret, d, sig_hashes[secret]);
+        }
       }
-      // fmt::print("Secret {} should have hashed to {}\n", secret, hashes[secret]);
+      secret_hasher.flush();
     }
 
     auto hasher = crypto::hash::blake3_init();
@@ -197,7 +367,7 @@ private:
 
   BatchMerkleTree tree;
   BatchedInfSignature::InfSignature root_sig;
-  std::vector<HorsMerkleTree> hors_pk_trees;
+  std::vector<HorsMerkleTree, SlabAllocator<HorsMerkleTree, InfBatchSize>> hors_pk_trees;
 };
 
-} // namespace dory::dsig
+} // namespace dory::DSIG_NS
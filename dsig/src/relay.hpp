@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "export/base-types.hpp"
+#include "export/namespace.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief k-ary trees along which the PK batches of each signer are relayed.
+ *
+ * The signer is the root of its tree and the verifiers fill it breadth-first:
+ * the signer sends its batches to `fanout` verifiers, each of which forwards
+ * them to `fanout` more, and so on. The egress of a signer per batch is thus
+ * O(fanout) instead of O(verifiers). The order of the verifiers is rotated per
+ * signer so that different signers rely on different relays.
+ *
+ * Relays are not trusted: receivers still check the root signature of every
+ * batch against the signer's Inf PK, and drop the batches they saw recently
+ * (see `SeenBatches`).
+ *
+ * A `fanout` of 0 disables relaying: signers send directly to every verifier.
+ */
+class RelayTree {
+ public:
+  RelayTree(ProcId const my_id, std::vector<ProcId> const &signers,
+            std::vector<ProcId> verifiers, size_t const fanout)
+      : fanout{fanout} {
+    std::sort(verifiers.begin(), verifiers.end());
+    verifiers.erase(std::unique(verifiers.begin(), verifiers.end()), verifiers.end());
+    for (auto const signer : signers) {
+      auto &to = children.try_emplace(signer).first->second;
+      std::vector<ProcId> order;
+      std::copy_if(verifiers.begin(), verifiers.end(), std::back_inserter(order),
+                   [signer](ProcId const id) { return id != signer; });
+      if (fanout == 0) {
+        if (signer == my_id) to = order;
+        continue;
+      }
+      if (order.empty()) continue;
+      std::rotate(order.begin(),
+                  order.begin() + static_cast<ptrdiff_t>(static_cast<size_t>(signer) % order.size()),
+                  order.end());
+      // Position 0 is the signer, position p > 0 is `order[p - 1]`.
+      size_t position;
+      if (signer == my_id) {
+        position = 0;
+      } else {
+        auto const it = std::find(order.begin(), order.end(), my_id);
+        if (it == order.end()) continue;
+        position = static_cast<size_t>(it - order.begin()) + 1;
+      }
+      for (size_t child = position * fanout + 1;
+           child <= position * fanout + fanout && child <= order.size(); child++) {
+        to.push_back(order[child - 1]);
+      }
+    }
+  }
+
+  bool enabled() const { return fanout != 0; }
+
+  /**
+   * @brief Processes to which this process sends (if it is `signer`) or
+   *        forwards the batches of `signer`.
+   */
+  std::vector<ProcId> const &targets(ProcId const signer) const {
+    auto const it = children.find(signer);
+    return it == children.end() ? none : it->second;
+  }
+
+ private:
+  size_t fanout;
+  std::map<ProcId, std::vector<ProcId>> children;
+  std::vector<ProcId> none;
+};
+
+/**
+ * @brief Ids of the last `window` batches received from each signer.
+ *
+ * A batch that was seen recently is neither processed nor forwarded again: a
+ * relay that replays valid batches thus neither evicts the live batches of
+ * the caches nor floods its subtree. Batches older than the window are caught
+ * by the caches only as long as they are cached.
+ */
+class SeenBatches {
+ public:
+  SeenBatches(size_t const window) : window{window} {}
+
+  // Returns whether `id` is new for `signer`, in which case it is remembered.
+  bool insert(ProcId const signer, uint64_t const id) {
+    auto &seen = signers[signer];
+    if (!seen.ids.insert(id).second) return false;
+    seen.order.push_back(id);
+    if (seen.order.size() > window) {
+      seen.ids.erase(seen.order.front());
+      seen.order.pop_front();
+    }
+    return true;
+  }
+
+ private:
+  struct Seen {
+    std::unordered_set<uint64_t> ids;
+    std::deque<uint64_t> order;
+  };
+  size_t window;
+  std::map<ProcId, Seen> signers;
+};
+
+}  // namespace dory::DSIG_NS
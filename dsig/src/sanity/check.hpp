@@ -1,5 +1,7 @@
 #pragma once
 
-namespace dory::dsig::sanity {
+#include "../export/namespace.hpp"
+
+namespace dory::DSIG_NS::sanity {
 void check();
 }
@@ -1,6 +1,8 @@
 #include <cstddef>
 
-namespace dory::dsig::sanity {
+#include "../export/namespace.hpp"
+
+namespace dory::DSIG_NS::sanity {
 // These should be filled by the preprocessor during compilation
 // IMPORTANT: Also edit `run-time.cpp`
 
@@ -15,4 +17,4 @@ size_t WotsLogSecretsDepth = WOTS_LOG_SECRETS_DEPTH;
 #define HORS_SECRETS_PER_SIGNATURE 19
 #endif
 size_t HorsSecretsPerSignature = HORS_SECRETS_PER_SIGNATURE;
-}  // namespace dory::dsig::sanity
+}  // namespace dory::DSIG_NS::sanity
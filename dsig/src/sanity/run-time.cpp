@@ -2,9 +2,10 @@
 #include <stdexcept>
 
 #include "../config.hpp"
+#include "../export/namespace.hpp"
 #include "check.hpp"
 
-namespace dory::dsig::sanity {
+namespace dory::DSIG_NS::sanity {
 // These should be filled by the preprocessor during compilation
 extern size_t HbssScheme;
 extern size_t HashingScheme;
@@ -22,4 +23,4 @@ void check() {
         "Mismatch of compile-time config vs run-time config of header files");
   }
 }
-}  // namespace dory::dsig::sanity
+}  // namespace dory::DSIG_NS::sanity
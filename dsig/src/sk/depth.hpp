@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+#include "../config.hpp"
+#include "../export/namespace.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Sizes the SK pipeline after the signing demand.
+ *
+ * The scheduler reports how many SKs were consumed so far. Every `Period`, the
+ * controller updates the average signing rate and the largest burst seen
+ * (which slowly decays), and targets enough SKs to absorb either of them
+ * twice, within `[min, max]`. An idle signer thus shrinks to `min` SKs (i.e.,
+ * stops generating them) within seconds, while a burst grows it right away.
+ *
+ * Depths are whole batches of `InfBatchSize` SKs.
+ */
+class SkDepthController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  SkDepthController(size_t const min, size_t const max)
+      : min{round_up(std::clamp(min, InfBatchSize, PreparedSks))},
+        max{round_up(std::clamp(max, this->min, PreparedSks))},
+        current_target{this->max} {}
+
+  /**
+   * @brief Accounts for the SKs consumed so far (monotonic count).
+   */
+  void update(size_t const consumed, Clock::time_point const now) {
+    if (now < next_update) return;
+    next_update = now + Period;
+    auto const delta = static_cast<double>(consumed - last_consumed);
+    last_consumed = consumed;
+
+    rate = rate * (1 - RateSmoothing) + delta * RateSmoothing;
+    burst = std::max(delta, burst * BurstDecay);
+    auto const wanted = Headroom * std::max(rate * RefillPeriods, burst);
+    auto const target = round_up(static_cast<size_t>(std::ceil(wanted)));
+    current_target.store(std::clamp(target, min, max), std::memory_order_relaxed);
+  }
+
+  size_t target() const {
+    return current_target.load(std::memory_order_relaxed);
+  }
+
+  bool adaptive() const { return min != max; }
+
+ private:
+  static constexpr Clock::duration Period = std::chrono::milliseconds(1);
+  // Exponential average over ~20 periods.
+  static constexpr double RateSmoothing = 0.05;
+  // Bursts are forgotten with a half-life of ~1s.
+  static constexpr double BurstDecay = 0.9993;
+  // Periods it takes to refill the pipeline.
+  static constexpr double RefillPeriods = 10;
+  static constexpr double Headroom = 2;
+
+  static size_t round_up(size_t const sks) {
+    return (sks + InfBatchSize - 1) / InfBatchSize * InfBatchSize;
+  }
+
+  size_t const min;
+  size_t const max;
+  std::atomic<size_t> current_target;
+
+  Clock::time_point next_update{};
+  size_t last_consumed{0};
+  double rate{0};
+  double burst{0};
+};
+
+}  // namespace dory::DSIG_NS
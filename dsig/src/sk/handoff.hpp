@@ -0,0 +1,319 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <dory/shared/branching.hpp>
+#include <dory/third-party/sync/mpmc.hpp>
+#include <dory/third-party/sync/spsc.hpp>
+
+#include "../config.hpp"
+#include "../export/namespace.hpp"
+#include "sk.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Hands the ready SKs over to the signing threads without locking.
+ *
+ * Each application thread that signs is lazily assigned its own SPSC ring.
+ * The scheduler is the single producer of all the rings: it keeps a reservoir
+ * of ready SKs and tops up each ring with half of its share of the SKs. The
+ * other half waits in a shared pool that threads whose ring ran dry pop from,
+ * so that a bursting thread does not wait while the others sit on their SKs.
+ *
+ * A thread releases its slot when it exits: the scheduler then takes back the
+ * SKs of its ring and the slot can be assigned to another thread.
+ *
+ * A thread that stays alive but has not popped an SK for `IdleAfter` is no
+ * longer topped up, and the share of the SKs is split among the others. As
+ * only its thread may dequeue from a ring, the SKs left in it stay there until
+ * the thread signs again: an idle thread strands at most the share it was last
+ * topped up to. They are not counted as reachable, so they are replaced.
+ */
+class SkHandoff {
+  using UniqueSk = std::unique_ptr<SecretKey>;
+  using Ring = third_party::sync::SpscQueue<UniqueSk>;
+
+  struct alignas(64) Slot {
+    // Released slots are reclaimed by the scheduler before being freed.
+    enum State { Free, Owned, Released };
+
+    Slot() : ring{PreparedSks} {}
+    Ring ring;
+    std::atomic<State> state{Free};
+    // SKs popped by the owner, from its ring or the shared pool.
+    std::atomic<uint64_t> pops{0};
+  };
+
+  // What the scheduler last saw of a slot.
+  struct Activity {
+    uint64_t pops{0};
+    std::chrono::steady_clock::time_point last_pop;
+    bool active{true};
+  };
+
+  // Shared with the threads' registrations, which may outlive the handoff.
+  struct Slots {
+    std::array<Slot, MaxSigningThreads> slots;
+    // Slots that were ever assigned are a prefix of `slots`.
+    std::atomic<size_t> used{0};
+
+    Slot &acquire() {
+      for (size_t i = 0; i < slots.size(); i++) {
+        auto expected = Slot::Free;
+        if (!slots[i].state.compare_exchange_strong(expected, Slot::Owned,
+                                                    std::memory_order_acquire)) {
+          continue;
+        }
+        auto seen = used.load();
+        while (seen <= i && !used.compare_exchange_weak(seen, i + 1));
+        return slots[i];
+      }
+      throw std::runtime_error("Too many threads signing with Dsig.");
+    }
+  };
+
+  // Releases the slots of a thread when it exits.
+  struct Registrations {
+    struct Registration {
+      std::weak_ptr<Slots> slots;
+      Slot *slot{nullptr};
+    };
+    std::unordered_map<uint64_t, Registration> by_instance;
+
+    ~Registrations() {
+      for (auto &[_, registration] : by_instance) {
+        if (auto const alive = registration.slots.lock()) {
+          registration.slot->state.store(Slot::Released, std::memory_order_release);
+        }
+      }
+    }
+  };
+
+ public:
+  SkHandoff() : id{next_id++}, slots{std::make_shared<Slots>()} {
+    activities.fill({0, std::chrono::steady_clock::now(), true});
+  }
+
+  // Time without popping an SK after which a thread is no longer topped up.
+  static constexpr std::chrono::milliseconds IdleAfter{100};
+
+  SkHandoff(SkHandoff const &) = delete;
+  SkHandoff &operator=(SkHandoff const &) = delete;
+  SkHandoff(SkHandoff &&) = delete;
+  SkHandoff &operator=(SkHandoff &&) = delete;
+
+  // Application threads
+
+  /**
+   * @brief Pops an SK from the calling thread's ring or, if it is empty, from
+   *        the shared pool, waiting for one if needed.
+   */
+  UniqueSk pop() {
+    auto &slot = mine();
+    UniqueSk sk;
+    while (!slot.ring.try_dequeue(sk) && !shared.try_dequeue(sk));
+    popped(slot, 1);
+    return sk;
+  }
+
+  /**
+   * @brief Pops an SK from the calling thread's ring or the shared pool, if
+   *        any.
+   */
+  UniqueSk try_pop() {
+    auto &slot = mine();
+    UniqueSk sk;
+    if (!slot.ring.try_dequeue(sk)) shared.try_dequeue(sk);
+    if (sk) popped(slot, 1);
+    return sk;
+  }
+
+  /**
+   * @brief Pops `nb` SKs into `sks` with a single lookup of the caller's ring.
+   */
+  void pop_many(UniqueSk *const sks, size_t const nb) {
+    auto &slot = mine();
+    for (size_t i = 0; i < nb; i++) {
+      while (!slot.ring.try_dequeue(sks[i]) && !shared.try_dequeue(sks[i]));
+    }
+    popped(slot, nb);
+  }
+
+  /**
+   * @brief Returns the next SK of the calling thread, if any.
+   */
+  SecretKey *peek() {
+    auto *const front = mine().ring.peek();
+    return front ? front->get() : nullptr;
+  }
+
+  /**
+   * @brief Number of SKs either in the reservoir, in the shared pool or handed
+   *        to a thread.
+   */
+  size_t available() const {
+    auto count = reservoir_size.load(std::memory_order_relaxed) + shared.size_approx();
+    auto const used = slots->used.load();
+    for (size_t i = 0; i < used; i++) {
+      count += slots->slots[i].ring.size_approx();
+    }
+    return count;
+  }
+
+  // Scheduler thread
+
+  /**
+   * @brief Number of SKs that may still reach any thread: unlike `available`,
+   *        only counts the SKs in the ring of an active thread up to its share,
+   *        and none of those in the ring of an idle one.
+   *
+   * A thread that stopped signing keeps the SKs of its ring, which may exceed
+   * its share once it shrank: counting them would starve the other threads.
+   */
+  size_t reachable() const {
+    auto count = reservoir.size() + shared.size_approx();
+    auto const used = slots->used.load();
+    for (size_t i = 0; i < used; i++) {
+      auto const &slot = slots->slots[i];
+      auto const in_ring = slot.ring.size_approx();
+      if (slot.state.load(std::memory_order_acquire) != Slot::Owned) {
+        // The SKs of the threads that exited are taken back.
+        count += in_ring;
+      } else if (activities[i].active) {
+        count += std::min(in_ring, share);
+      }
+    }
+    return count;
+  }
+
+  void push(UniqueSk &&sk) {
+    reservoir.emplace_back(std::move(sk));
+    reservoir_size.store(reservoir.size(), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Moves SKs from the reservoir to the rings of the active threads and
+   *        to the shared pool, so that they hold `depth` SKs altogether.
+   *
+   * The SKs of the threads that exited are taken back first.
+   */
+  void distribute(size_t const depth = PreparedSks) {
+    size_t active = 0;
+    auto const now = std::chrono::steady_clock::now();
+    auto const used = slots->used.load();
+    for (size_t i = 0; i < used; i++) {
+      auto &slot = slots->slots[i];
+      auto &activity = activities[i];
+      auto const state = slot.state.load(std::memory_order_acquire);
+      if (state == Slot::Released) {
+        // The thread is gone: we are the only consumer of its ring.
+        UniqueSk sk;
+        while (slot.ring.try_dequeue(sk)) reservoir.emplace_back(std::move(sk));
+        // The next owner starts active, so that its ring is topped up.
+        slot.pops.store(0, std::memory_order_relaxed);
+        activity = {0, now, true};
+        slot.state.store(Slot::Free, std::memory_order_release);
+        continue;
+      }
+      if (state != Slot::Owned) continue;
+      auto const pops = slot.pops.load(std::memory_order_relaxed);
+      if (pops != activity.pops) {
+        activity.pops = pops;
+        activity.last_pop = now;
+      }
+      activity.active = now - activity.last_pop < IdleAfter;
+      active += activity.active;
+    }
+    if (active != 0) {
+      share = (depth / 2 + active - 1) / active;
+      for (size_t i = 0; i < used && !reservoir.empty(); i++) {
+        auto &slot = slots->slots[i];
+        if (slot.state.load(std::memory_order_relaxed) != Slot::Owned ||
+            !activities[i].active) {
+          continue;
+        }
+        for (auto in_ring = slot.ring.size_approx();
+             in_ring < share && !reservoir.empty(); in_ring++) {
+          if (!slot.ring.try_enqueue(std::move(reservoir.front()))) break;
+          reservoir.pop_front();
+        }
+      }
+    }
+    while (!reservoir.empty()) {
+      shared.enqueue(std::move(reservoir.front()));
+      reservoir.pop_front();
+    }
+    reservoir_size.store(reservoir.size(), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Takes back all the SKs, handed to a thread or not.
+   *
+   * Only valid once no thread signs anymore (i.e., on shutdown).
+   */
+  std::deque<UniqueSk> drain() {
+    auto sks = std::move(reservoir);
+    reservoir.clear();
+    UniqueSk sk;
+    while (shared.try_dequeue(sk)) sks.emplace_back(std::move(sk));
+    auto const used = slots->used.load();
+    for (size_t i = 0; i < used; i++) {
+      while (slots->slots[i].ring.try_dequeue(sk)) sks.emplace_back(std::move(sk));
+    }
+    reservoir_size.store(0, std::memory_order_relaxed);
+    return sks;
+  }
+
+ private:
+  // Only the owner writes `pops`: no need for an atomic increment.
+  static void popped(Slot &slot, size_t const nb) {
+    slot.pops.store(slot.pops.load(std::memory_order_relaxed) + nb,
+                    std::memory_order_relaxed);
+  }
+
+  Slot &mine() {
+    // Fast path: the thread keeps using the same instance.
+    thread_local uint64_t cached_id{0};
+    thread_local Slot *cached_slot{nullptr};
+    if (likely(cached_id == id)) return *cached_slot;
+
+    thread_local Registrations registrations;
+    auto &by_instance = registrations.by_instance;
+    auto &registration = by_instance[id];
+    if (!registration.slot) {
+      // Forgets the instances that were destroyed.
+      for (auto it = by_instance.begin(); it != by_instance.end();) {
+        it = it->second.slots.expired() && it->first != id ? by_instance.erase(it)
+                                                           : std::next(it);
+      }
+      registration.slot = &slots->acquire();
+      registration.slots = slots;
+    }
+    cached_id = id;
+    cached_slot = registration.slot;
+    return *cached_slot;
+  }
+
+  // Ids distinguish instances in the thread-local caches (0 is never used).
+  static inline std::atomic<uint64_t> next_id{1};
+  uint64_t const id;
+
+  std::shared_ptr<Slots> slots;
+  third_party::sync::MpmcQueue<UniqueSk> shared;
+
+  std::deque<UniqueSk> reservoir;
+  std::atomic<size_t> reservoir_size{0};
+  // SKs that `distribute` last put in the ring of each thread, at most.
+  size_t share{PreparedSks};
+  std::array<Activity, MaxSigningThreads> activities;
+};
+
+}  // namespace dory::DSIG_NS
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <deque>
@@ -13,6 +14,7 @@
 #include <dory/shared/types.hpp>
 
 #include "../config.hpp"
+#include "../export/namespace.hpp"
 #include "../mutex.hpp"
 #include "../network.hpp"
 #include "../pk/pk.hpp"
@@ -21,7 +23,7 @@
 #include "random.hpp"
 #include "sk.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 class SkPipeline {
  protected:
@@ -31,35 +33,42 @@ class SkPipeline {
     enum State {
       Initialized,
       Computed,
+      Failed,
     };
     std::array<std::unique_ptr<SecretKey>, Size> sks;
     Delayed<BatchMerkleTree> tree;
-    BgPublicKeys::Compressed to_send;
+    // Shared with the SKs, which may have to send it again.
+    std::shared_ptr<BgPublicKeys::Compressed> to_send{std::make_shared<BgPublicKeys::Compressed>()};
     std::atomic<State> state{Initialized};
-    void schedule(Workers& workers, InfCrypto& inf_crypto) {
-      workers.schedule([this, &inf_crypto] {
-        sign(inf_crypto);
-        #if HBSS_SCHEME == HORS_MERKLE
-        for (size_t sk_idx = 0; sk_idx < Size; sk_idx++) {
-          to_send.hors_pk_leaves.at(sk_idx) = sks.at(sk_idx)->getPk();
-        }
-        #endif
-      });
+    void schedule(Workers& workers, InfCrypto& inf_crypto, ProcId const signer) {
+      workers.schedule(
+          [this, &inf_crypto, signer] {
+            #if HBSS_SCHEME == HORS_MERKLE
+            for (size_t sk_idx = 0; sk_idx < Size; sk_idx++) {
+              to_send->hors_pk_leaves.at(sk_idx) = sks.at(sk_idx)->getPk();
+            }
+            #endif
+            sign(inf_crypto, signer);
+          },
+          [this](std::exception_ptr) { state = Failed; });
     }
    private:
-    void sign(InfCrypto& inf_crypto) {
+    void sign(InfCrypto& inf_crypto, ProcId const signer) {
       for (size_t i = 0; i < Size; i++)
-        to_send.pk_hashes[i] = sks[i]->getPkHash();
-      tree.emplace(to_send.pk_hashes);
-      to_send.root_sig = inf_crypto.sign(reinterpret_cast<uint8_t const*>(tree->root().data()), tree->root().size());
-      for (size_t i = 0; i < Size; i++)
-        sks[i]->pk_sig.emplace(to_send.pk_hashes[i], tree.value(), i, to_send.root_sig);
+        to_send->pk_hashes[i] = sks[i]->getPkHash();
+      tree.emplace(to_send->pk_hashes);
+      to_send->root_sig = inf_crypto.sign(reinterpret_cast<uint8_t const*>(tree->root().data()), tree->root().size(), signer);
+      for (size_t i = 0; i < Size; i++) {
+        sks[i]->pk_sig.emplace(to_send->pk_hashes[i], tree.value(), i, to_send->root_sig);
+        sks[i]->batch = to_send;
+      }
       state = Computed;
     }
   };
  public:
-  SkPipeline(Network& net, InfCrypto& inf, Workers& workers)
-      : net{net}, inf_crypto{inf}, workers{workers} { }
+  // Prepares the SKs of `signer`, one of the identities of this process.
+  SkPipeline(Network& net, InfCrypto& inf, Workers& workers, ProcId const signer)
+      : net{net}, inf_crypto{inf}, workers{workers}, signer{signer} { }
 
   SkPipeline(SkPipeline const&) = delete;
   SkPipeline& operator=(SkPipeline const&) = delete;
@@ -70,8 +79,19 @@ class SkPipeline {
     schedule_new_sks();
     batch_sign_computed_sks();
     send_signed_sks();
+    depth.store(initializing_sks.size() + sks_batchs.size() * InfBatchSize + ready_sks.size(),
+                std::memory_order_relaxed);
   }
 
+  /**
+   * @brief Sets how many SKs each stage of the pipeline holds (at most
+   *        `PreparedSks`).
+   */
+  void set_target(size_t const sks) { target = sks; }
+
+  // SKs in the pipeline, ready or not.
+  size_t prepared() const { return depth.load(std::memory_order_relaxed); }
+
   std::unique_ptr<SecretKey> extract_ready() {
     std::scoped_lock<Mutex> lock(ready_sks_mutex);
     if (ready_sks.empty()) {
@@ -83,9 +103,31 @@ class SkPipeline {
     return sk;
   }
 
+  // All the SKs that were sent but not extracted (on shutdown).
+  std::deque<std::unique_ptr<SecretKey>> drain_ready() {
+    std::scoped_lock<Mutex> lock(ready_sks_mutex);
+    auto sks = std::move(ready_sks);
+    ready_sks.clear();
+    return sks;
+  }
+
  protected:
   void schedule_new_sks() {
-    while (initializing_sks.size() != PreparedSks) {
+    // SKs whose generation failed are replaced.
+    auto const failed = std::remove_if(
+        initializing_sks.begin(), initializing_sks.end(),
+        [](auto const& sk) { return sk->state == SecretKey::State::Failed; });
+    if (failed != initializing_sks.end()) {
+      LOGGER_WARN(logger, "Dropping {} SKs whose generation failed.",
+                  initializing_sks.end() - failed);
+      initializing_sks.erase(failed, initializing_sks.end());
+    }
+    // Surplus SKs are discarded once built (workers still reference the others).
+    while (initializing_sks.size() > target &&
+           initializing_sks.back()->state == SecretKey::State::Initialized) {
+      initializing_sks.pop_back();
+    }
+    while (initializing_sks.size() < target) {
       auto seed = seed_generator.generate();
       initializing_sks.emplace_back(std::make_unique<SecretKey>(seed, workers));
       // fmt::print("Sk emplaced: #initializing_sks={}\n", initializing_sks.size());
@@ -94,11 +136,11 @@ class SkPipeline {
 
   void batch_sign_computed_sks() {
     while (true) {
-      if (sks_batchs.size() * InfBatchSize >= PreparedSks) return;
+      if (sks_batchs.size() * InfBatchSize >= target) return;
       // Count the prefix so that they are all initialized
       size_t done = 0;
       for (auto& sk : initializing_sks) {
-        if (sk->state == SecretKey::State::Initializing) break;
+        if (sk->state != SecretKey::State::Initialized) break;
         done++;
         if (done == InfBatchSize) break;
       }
@@ -110,15 +152,20 @@ class SkPipeline {
         initializing_sks.pop_front();
       }
       // fmt::print("Sks moved to batch: #initializing_sks={}, #sks_batchs={}\n", initializing_sks.size(), sks_batchs.size());
-      sks_batchs.back().schedule(workers, inf_crypto);
+      sks_batchs.back().schedule(workers, inf_crypto, signer);
     }
   }
 
   void send_signed_sks() {
+    while (!sks_batchs.empty() && sks_batchs.front().state == SigningBatch::State::Failed) {
+      LOGGER_WARN(logger, "Dropping a batch of SKs that could not be signed.");
+      sks_batchs.pop_front();
+    }
     while (!sks_batchs.empty() && sks_batchs.front().state == SigningBatch::State::Computed) {
-      if (ready_sks.size() >= PreparedSks) return;
+      // SKs are only handed out once their PKs were sent.
+      if (ready_sks.size() >= target) return;
       auto& batch = sks_batchs.front();
-      net.send(batch.to_send);
+      net.send(*batch.to_send, signer);
       std::scoped_lock<Mutex> lock(ready_sks_mutex);
       for (auto& sk : batch.sks)
         ready_sks.push_back(std::move(sk));
@@ -127,6 +174,9 @@ class SkPipeline {
     }
   }
 
+  size_t target{PreparedSks};
+  std::atomic<size_t> depth{0};
+
   std::deque<std::unique_ptr<SecretKey>> initializing_sks;
   std::deque<SigningBatch> sks_batchs;
   std::deque<std::unique_ptr<SecretKey>> ready_sks;
@@ -135,9 +185,10 @@ class SkPipeline {
   Network& net;
   InfCrypto& inf_crypto;
   Workers& workers;
+  ProcId const signer;
   RandomGenerator seed_generator;
 
   LOGGER_DECL_INIT(logger, "Dsig::SkPipeline");
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -1,12 +1,15 @@
+#pragma once
+
 #include <atomic>
 #include <fstream>
 #include <stdexcept>
 
 #include <dory/crypto/hash/blake3.hpp>
 
+#include "../export/namespace.hpp"
 #include "../types.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 class RandomGenerator {
  public:
@@ -31,4 +34,4 @@ class RandomGenerator {
   static constexpr char const* dev = "/dev/random";
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <atomic>
+#include <exception>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <type_traits>
 
+#include "../export/namespace.hpp"
 #include "../merkle.hpp"
+#include "../message.hpp"
+#include "../pk/pk.hpp"
+#include "../slab.hpp"
 #include "../types.hpp"
 #include "../util.hpp"
 #include "../workers.hpp"
@@ -13,19 +19,56 @@
 #include "../hors.hpp"
 #include "../wots.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
-class SecretKey {
+// Recycled through a slab, as are its HORS tree and proofs.
+class SecretKey: public SlabAllocated<SecretKey> {
   using SecretRow = std::array<Secret, SecretsPerSecretKey>;
   using Secrets = std::array<SecretRow, SecretsDepth>;
 public:
+  /**
+   * @brief Authentication paths of all the leaves of a HORS Merkle tree, each
+   *        in its own cache-aligned slot.
+   *
+   * They are extracted by the worker that builds the SK, so that signing only
+   * gathers the paths of the revealed leaves. The table replaces the tree, but
+   * is larger by about half the path length: it is only used when it fits in
+   * `MaxSize`.
+   */
+  struct HorsProofs {
+    struct alignas(64) Slot {
+      HorsMerkleProof proof;
+    };
+    static size_t constexpr MaxSize = 256 << 10;
+
+    explicit HorsProofs(HorsMerkleTree const& tree): roots{tree.roots()} {
+      for (size_t leaf = 0; leaf < slots.size(); leaf++) {
+        slots[leaf].proof = HorsMerkleProof(tree, leaf);
+      }
+    }
+
+    HorsMerkleTree::Roots roots;
+    std::array<Slot, HorsMerkleTree::NbLeaves> slots;
+  };
+  static bool constexpr PrecomputedHorsProofs =
+      HbssScheme == HorsMerkle && sizeof(HorsProofs) <= HorsProofs::MaxSize;
+
+  // SKs whose generation threw end up `Failed` and are to be dropped.
   enum State {
     Initializing,
     Initialized,
+    Failed,
   };
 
   SecretKey(Seed const seed, Workers& workers): seed{seed} {
-    workers.schedule([this]{ generate(); });
+    schedule(workers);
+  }
+
+  // Rebuilds an SK whose PK was already signed (e.g., from a snapshot).
+  SecretKey(Seed const seed, Workers& workers, BatchedInfSignature const& pk_sig,
+            std::shared_ptr<BgPublicKeys::Compressed const> batch)
+      : pk_sig{pk_sig}, batch{std::move(batch)}, seed{seed} {
+    schedule(workers);
   }
 
   SecretKey(SecretKey const&) = delete;
@@ -33,25 +76,47 @@ public:
   SecretKey(SecretKey&&) = delete;
   SecretKey& operator=(SecretKey&&) = delete;
 
+  // Hash of the message that determines which secrets to reveal.
+  using MsgHash = std::conditional_t<HbssScheme == Wots, WotsHash, HorsHash>;
+
+  MsgHash hash(MsgView const& msg) const {
+    return MsgHash(pk_hash, nonce, msg);
+  }
+
+  // To feed the message incrementally, then sign `MsgHash(hasher)`.
+  MsgHasher hasher() const {
+    return MsgHasher(pk_hash, nonce);
+  }
+
+  Signature sign(MsgView const& msg) const {
+    return sign(hash(msg));
+  }
+
   template <typename S = Signature, std::enable_if_t<std::is_same_v<S, HorsMerkleSignature>, bool> = true>
-  HorsMerkleSignature sign(uint8_t const* msg, size_t const msg_len) const {
+  HorsMerkleSignature sign(HorsHash const& h) const {
     HorsMerkleSignature sig{pk_nonce, pk_sig.value(), nonce};
-    sig.roots = hors_pk_tree->roots();
-    HorsHash h(pk_hash, nonce, msg, msg + msg_len);
+    if constexpr (PrecomputedHorsProofs) {
+      sig.roots = hors_proofs->roots;
+    } else {
+      sig.roots = hors_pk_tree->roots();
+    }
     for (size_t i = 0; i < SecretsPerSignature; i++) {
       auto const secret_index = h.getSecretIndex(i);
       SecretAndNeighborHash const secretAndNeighborHash = {secrets.front()[secret_index], secrets.back()[secret_index ^ 1]};
       sig.secretsAndNeighborsHash.at(i) = secretAndNeighborHash;
-      sig.proofs.at(i) = HorsMerkleProof(*hors_pk_tree, secret_index >> 1);
+      if constexpr (PrecomputedHorsProofs) {
+        sig.proofs[i] = hors_proofs->slots[secret_index >> 1].proof;
+      } else {
+        sig.proofs.at(i) = HorsMerkleProof(*hors_pk_tree, secret_index >> 1);
+      }
     }
     return sig;
   }
 
   template <typename S = Signature, std::enable_if_t<std::is_same_v<S, HorsCompletedSignature>, bool> = true>
-  HorsCompletedSignature sign(uint8_t const* msg, size_t const msg_len) const {
+  HorsCompletedSignature sign(HorsHash const& h) const {
     HorsCompletedSignature sig{pk_nonce, pk_sig.value(), nonce};
     std::memcpy(sig.fused_secrets.data(), secrets.back().data(), sizeof(sig.fused_secrets));
-    HorsHash h(pk_hash, nonce, msg, msg + msg_len);
     for (size_t i = 0; i < SecretsPerSignature; i++) {
       auto const secret_index = h.getSecretIndex(i);
       sig.fused_secrets[secret_index] = secrets.front()[secret_index];
@@ -60,9 +125,8 @@ public:
   }
 
   template <typename S = Signature, std::enable_if_t<std::is_same_v<S, WotsSignature>, bool> = true>
-  WotsSignature sign(uint8_t const* msg, size_t const msg_len) const {
+  WotsSignature sign(WotsHash const& h) const {
     WotsSignature sig{pk_nonce, pk_sig.value(), nonce};
-    WotsHash h(pk_hash, nonce, msg, msg + msg_len);
     for (size_t i = 0; i < SecretsPerSignature; i++) {
       auto const secret_depth = h.getSecretDepth(i);
       std::memcpy(sig.secrets[i].data(), secrets[secret_depth][i].data(), sig.secrets[i].size());
@@ -72,6 +136,8 @@ public:
 
   std::atomic<State> state{Initializing};
   std::optional<BatchedInfSignature> pk_sig;
+  // The PK batch as sent, shared by its SKs, so that it can be sent again.
+  std::shared_ptr<BgPublicKeys::Compressed const> batch;
 
   SecretRow const& getPk() const {
     return secrets.back();
@@ -81,16 +147,34 @@ public:
     return pk_hash;
   }
 
+  Seed const& getSeed() const {
+    return seed;
+  }
+
   void prefetch() {
-    dsig::prefetch(*this);
-    if constexpr (HbssScheme == HorsMerkle) {
-      dsig::prefetch(*hors_pk_tree);
+    DSIG_NS::prefetch(*this);
+    if constexpr (PrecomputedHorsProofs) {
+      DSIG_NS::prefetch(*hors_proofs);
+    } else if constexpr (HbssScheme == HorsMerkle) {
+      DSIG_NS::prefetch(*hors_pk_tree);
+    }
+  }
+
+  // Non-blocking version of `prefetch`: only hints the hardware.
+  void prefetch_hint() const {
+    DSIG_NS::prefetch_hint(*this);
+    if constexpr (PrecomputedHorsProofs) {
+      DSIG_NS::prefetch_hint(*hors_proofs);
+    } else if constexpr (HbssScheme == HorsMerkle) {
+      DSIG_NS::prefetch_hint(*hors_pk_tree);
     }
   }
 
 private:
   Secrets secrets;
-  std::unique_ptr<HorsMerkleTree> hors_pk_tree;
+  // Only one of them is kept, depending on `PrecomputedHorsProofs`.
+  SlabPtr<HorsMerkleTree> hors_pk_tree;
+  SlabPtr<HorsProofs> hors_proofs;
   Seed seed;
 
   Nonce pk_nonce;
@@ -100,28 +184,24 @@ private:
 
   void generate_secrets() {
     secrets.front() = crypto::hash::blake3<SecretRow>(seed);
+    SecretHasher secret_hasher;
     for (size_t i = 0; i + 1 < SecretsDepth; i++) {
-      if constexpr (HashingScheme == Haraka) {
-        // 4x speedup
-        auto const speedup_until = SecretsPerSecretKey - SecretsPerSecretKey % 4;
-        for (size_t j = 0; j < speedup_until; j += 4) {
-          auto& secret_hash_4x = *reinterpret_cast<SecretHash4x*>(&secrets[i + 1][j]);
-          auto& secret_4x = *reinterpret_cast<Secret4x*>(&secrets[i][j]);
-          secret_hash_4x = hash_secret_haraka_4x(secret_4x, pk_nonce, j, i);
-        }
-        for (size_t j = speedup_until; j < SecretsPerSecretKey; j++) {
-          secrets[i + 1][j] = hash_secret(secrets[i][j], pk_nonce, j, i);
-        }
-      } else {
-        for (size_t j = 0; j < SecretsPerSecretKey; j++) {
-          secrets[i + 1][j] = hash_secret(secrets[i][j], pk_nonce, j, i);
-        }
+      for (size_t j = 0; j < SecretsPerSecretKey; j++) {
+        secret_hasher.push(secrets[i][j], pk_nonce, j, i, secrets[i + 1][j]);
       }
+      // The next depth hashes this one.
+      secret_hasher.flush();
     }
   }
 
+
   void generate_hors_pk_tree() {
-    hors_pk_tree = std::make_unique<HorsMerkleTree>(secrets.back(), true);
+    hors_pk_tree = make_slab<HorsMerkleTree>(secrets.back(), true);
+  }
+
+  void generate_hors_proofs() {
+    hors_proofs = make_slab<HorsProofs>(*hors_pk_tree);
+    hors_pk_tree.reset();
   }
 
   void generate_pk_nonce() {
@@ -131,7 +211,9 @@ private:
   void generate_pk_hash() {
     auto hasher = crypto::hash::blake3_init();
     crypto::hash::blake3_update(hasher, pk_nonce);
-    if constexpr (HbssScheme == HorsMerkle) {
+    if constexpr (PrecomputedHorsProofs) {
+      crypto::hash::blake3_update(hasher, hors_proofs->roots);
+    } else if constexpr (HbssScheme == HorsMerkle) {
       crypto::hash::blake3_update(hasher, hors_pk_tree->roots());
     } else {
       crypto::hash::blake3_update(hasher, secrets.back());
@@ -143,12 +225,20 @@ private:
     nonce = sig_nonce(seed);
   }
 
+  void schedule(Workers& workers) {
+    workers.schedule([this] { generate(); },
+                     [this](std::exception_ptr) { state = Failed; });
+  }
+
   void generate() {
     generate_pk_nonce();
     generate_secrets();
     if constexpr (HbssScheme == HorsMerkle) {
       generate_hors_pk_tree();
     }
+    if constexpr (PrecomputedHorsProofs) {
+      generate_hors_proofs();
+    }
     generate_pk_hash();
     generate_nonce();
     state = Initialized;
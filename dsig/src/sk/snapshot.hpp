@@ -0,0 +1,320 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+#include <dory/crypto/hash/blake3.hpp>
+#include <dory/third-party/blake3/blake3.h>
+
+#include "../export/namespace.hpp"
+#include "../pk/pk.hpp"
+#include "../types.hpp"
+#include "random.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Encrypted file of SKs that were signed (and sent) but not used, so
+ *        that a restarted signer can serve signatures right away.
+ *
+ * An SK is fully determined by its seed, so only the seeds and the batched Inf
+ * signatures of their PKs are stored, along with the PK batches they belong to
+ * so that these can be sent again: the verifiers may not have them anymore.
+ * As the Inf keys are new on every start, the batches are signed again on
+ * restore and the stored root signatures are not used.
+ * Seeds are encrypted with a keystream derived from a 32-byte key and a random
+ * nonce, and the whole file is authenticated (BLAKE3 in keyed mode for both).
+ *
+ * SKs must never sign twice: loading a snapshot consumes it. The file is
+ * locked while it is mapped, so that concurrent loaders take turns, then
+ * invalidated on disk and unlinked before any of its SKs is handed out, so a
+ * crash afterwards loses them rather than reusing them. If either cannot be
+ * made durable, the SKs are not used.
+ */
+class SkSnapshot {
+ public:
+  using Batch = BgPublicKeys::Compressed;
+
+  struct Record {
+    Seed seed;
+    BatchedInfSignature pk_sig;
+    // Index of the PK batch of the SK among the stored ones.
+    uint64_t batch;
+  };
+
+  struct Contents {
+    std::vector<Record> records;
+    std::vector<Batch> batches;
+  };
+
+  SkSnapshot(std::string path, std::string const &key_path, ProcId const id)
+      : path{std::move(path)}, id{id} {
+    std::ifstream key_file(key_path, std::ios::in | std::ios::binary);
+    Key key;
+    key_file.read(reinterpret_cast<char *>(key.data()), key.size());
+    if (!key_file) {
+      throw std::runtime_error(
+          fmt::format("Could not read a {}-byte snapshot key from {}", key.size(), key_path));
+    }
+    enc_key = derive(key, "dsig sk snapshot 2024 encryption");
+    mac_key = derive(key, "dsig sk snapshot 2024 authentication");
+  }
+
+  /**
+   * @brief Loads and consumes the snapshot, if any.
+   *
+   * A snapshot that is invalid (e.g., of another configuration) is discarded.
+   */
+  Contents load() {
+    auto const fd = ::open(path.c_str(), O_RDWR);
+    if (fd == -1) return {};
+    // Held until the snapshot is consumed and unlinked, so that another
+    // instance loading it at the same time finds it gone.
+    int locked;
+    while ((locked = ::flock(fd, LOCK_EX)) == -1 && errno == EINTR);
+    if (locked == -1) {
+      fmt::print(stderr, "[DSIG] Not using the SK snapshot {}: it could not be locked ({}).\n",
+                 path, std::strerror(errno));
+      ::close(fd);
+      return {};
+    }
+    auto contents = load_locked(fd);
+    ::close(fd);
+    return contents;
+  }
+
+  /**
+   * @brief Atomically replaces the snapshot with `records`.
+   */
+  void store(Contents contents) {
+    Header header;
+    header.magic = Magic;
+    header.fingerprint = fingerprint();
+    header.count = contents.records.size();
+    header.nb_batches = contents.batches.size();
+    header.nonce = RandomGenerator().generate();
+    crypt(header.nonce, contents.records);
+
+    auto const size = sizeof(Header) + body_size(header);
+    std::vector<uint8_t> file(size);
+    auto *const body = file.data() + sizeof(Header);
+    std::memcpy(body, contents.records.data(), header.count * sizeof(Record));
+    std::memcpy(body + header.count * sizeof(Record), contents.batches.data(),
+                header.nb_batches * sizeof(Batch));
+    header.mac = mac(header, body);
+    std::memcpy(file.data(), &header, sizeof(Header));
+
+    auto const tmp = path + ".tmp";
+    auto const fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) {
+      throw std::runtime_error(fmt::format("Could not create the snapshot {}: {}", tmp,
+                                           std::strerror(errno)));
+    }
+    for (size_t written = 0; written < size;) {
+      auto const ret = ::write(fd, file.data() + written, size - written);
+      if (ret == -1 && errno == EINTR) continue;
+      if (ret == -1) {
+        fail_store(fd, tmp, "write");
+      }
+      written += static_cast<size_t>(ret);
+    }
+    if (::fsync(fd) == -1) {
+      fail_store(fd, tmp, "sync");
+    }
+    ::close(fd);
+    if (::rename(tmp.c_str(), path.c_str()) == -1) {
+      fail_store(-1, tmp, "move");
+    }
+    if (!sync_dir()) {
+      throw std::runtime_error(fmt::format("Could not sync the directory of {}: {}", path,
+                                           std::strerror(errno)));
+    }
+  }
+
+ private:
+  using Key = std::array<uint8_t, BLAKE3_KEY_LEN>;
+  static uint64_t constexpr Magic = 0x70616e5347495344;  // "DSIGSnap"
+
+  struct Header {
+    uint64_t magic;
+    uint64_t fingerprint;
+    uint64_t count;
+    uint64_t nb_batches;
+    Seed nonce;
+    Hash mac;
+  };
+
+  // Loads and consumes the snapshot opened as `fd`, which is locked.
+  Contents load_locked(int const fd) const {
+    struct stat st;
+    auto const stated = ::fstat(fd, &st) == 0;
+    // Consumed by another instance while we waited for the lock.
+    if (stated && st.st_nlink == 0) return {};
+    if (!stated || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+      discard("truncated");
+      return {};
+    }
+    auto const size = static_cast<size_t>(st.st_size);
+    auto *const map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+      discard("cannot be mapped");
+      return {};
+    }
+
+    auto &header = *static_cast<Header *>(map);
+    auto *const body = static_cast<uint8_t *>(map) + sizeof(Header);
+    Contents contents;
+    char const *error = nullptr;
+    if (header.magic != Magic) {
+      error = "has been consumed";
+    } else if (header.fingerprint != fingerprint()) {
+      error = "is of another configuration";
+    } else if (header.count > size || header.nb_batches > size ||
+               body_size(header) != size - sizeof(Header)) {
+      error = "has an invalid size";
+    } else if (mac(header, body) != header.mac) {
+      error = "is not authentic";
+    } else {
+      contents.records.resize(header.count);
+      std::memcpy(contents.records.data(), body, header.count * sizeof(Record));
+      contents.batches.resize(header.nb_batches);
+      std::memcpy(contents.batches.data(), body + header.count * sizeof(Record),
+                  header.nb_batches * sizeof(Batch));
+      for (auto const &record : contents.records) {
+        if (record.batch >= contents.batches.size()) error = "is inconsistent";
+      }
+    }
+
+    auto const nonce = header.nonce;
+    // Consume it before any SK is used.
+    header.magic = 0;
+    auto const consumed = ::msync(map, size, MS_SYNC) == 0;
+    ::munmap(map, size);
+    if (error) {
+      discard(error);
+      return {};
+    }
+    if (!consumed) {
+      discard("could not be consumed");
+      return {};
+    }
+    if (!remove()) {
+      fmt::print(stderr, "[DSIG] Not using the SK snapshot {}: it could not be removed ({}).\n",
+                 path, std::strerror(errno));
+      return {};
+    }
+
+    crypt(nonce, contents.records);
+    return contents;
+  }
+
+  static size_t body_size(Header const &header) {
+    return header.count * sizeof(Record) + header.nb_batches * sizeof(Batch);
+  }
+
+  // Snapshots are only valid for the same process and compile-time config.
+  uint64_t fingerprint() const {
+    auto hasher = crypto::hash::blake3_init();
+    crypto::hash::blake3_update(hasher, id);
+    crypto::hash::blake3_update(hasher, HbssScheme);
+    crypto::hash::blake3_update(hasher, HashingScheme);
+    crypto::hash::blake3_update(hasher, LogInfBatchSize);
+    crypto::hash::blake3_update(hasher, SecretsPerSecretKey);
+    crypto::hash::blake3_update(hasher, SecretsDepth);
+    crypto::hash::blake3_update(hasher, sizeof(Record));
+    crypto::hash::blake3_update(hasher, sizeof(Batch));
+    auto const hash = crypto::hash::blake3_final(hasher);
+    uint64_t fp;
+    std::memcpy(&fp, hash.data(), sizeof(fp));
+    return fp;
+  }
+
+  static Key derive(Key const &key, char const *const context) {
+    blake3_hasher hasher;
+    blake3_hasher_init_derive_key(&hasher, context);
+    blake3_hasher_update(&hasher, key.data(), key.size());
+    Key derived;
+    blake3_hasher_finalize(&hasher, derived.data(), derived.size());
+    return derived;
+  }
+
+  // XORs the seeds with a keystream (only they are secret).
+  void crypt(Seed const &nonce, std::vector<Record> &records) const {
+    if (records.empty()) return;
+    blake3_hasher hasher;
+    blake3_hasher_init_keyed(&hasher, enc_key.data());
+    blake3_hasher_update(&hasher, nonce.data(), nonce.size());
+    std::vector<uint8_t> stream(records.size() * sizeof(Seed));
+    blake3_hasher_finalize(&hasher, stream.data(), stream.size());
+    for (size_t i = 0; i < records.size(); i++) {
+      for (size_t b = 0; b < sizeof(Seed); b++) {
+        records[i].seed[b] ^= stream[i * sizeof(Seed) + b];
+      }
+    }
+  }
+
+  // Authenticates everything but the MAC itself.
+  Hash mac(Header const &header, uint8_t const *const body) const {
+    blake3_hasher hasher;
+    blake3_hasher_init_keyed(&hasher, mac_key.data());
+    blake3_hasher_update(&hasher, &header, offsetof(Header, mac));
+    blake3_hasher_update(&hasher, body, body_size(header));
+    Hash out;
+    blake3_hasher_finalize(&hasher, out.data(), out.size());
+    return out;
+  }
+
+  void discard(char const *const error) const {
+    fmt::print(stderr, "[DSIG] Discarding the SK snapshot {}: it {}.\n", path, error);
+    remove();
+  }
+
+  // Unlinks the snapshot durably.
+  bool remove() const {
+    return ::unlink(path.c_str()) == 0 && sync_dir();
+  }
+
+  // Makes the last rename or unlink in the directory of the snapshot durable.
+  bool sync_dir() const {
+    auto const slash = path.find_last_of('/');
+    auto const dir = slash == std::string::npos ? std::string{"."}
+                     : slash == 0               ? std::string{"/"}
+                                                : path.substr(0, slash);
+    auto const fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd == -1) return false;
+    auto const synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+  }
+
+  [[noreturn]] static void fail_store(int const fd, std::string const &tmp,
+                                      char const *const step) {
+    auto const error = errno;
+    if (fd != -1) ::close(fd);
+    ::unlink(tmp.c_str());
+    throw std::runtime_error(
+        fmt::format("Could not {} the snapshot {}: {}", step, tmp, std::strerror(error)));
+  }
+
+  std::string path;
+  ProcId id;
+  Key enc_key;
+  Key mac_key;
+};
+
+}  // namespace dory::DSIG_NS
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dory/shared/branching.hpp>
+#include <dory/shared/logger.hpp>
+
+#include "export/namespace.hpp"
+#include "mutex.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Anonymous private memory, optionally on 2MiB hugepages.
+ *
+ * Unlike a memfd-backed buffer, it holds no file descriptor: unmapping it is
+ * enough to return its pages to the system.
+ */
+class SlabChunk {
+ public:
+  SlabChunk(size_t const length, bool const hugepages) : length{length} {
+    // Without MAP_NORESERVE, hugepages are reserved here, so that a depleted
+    // pool fails the mapping rather than a later page fault.
+    auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (hugepages) flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+    addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (addr == MAP_FAILED) {
+      throw std::runtime_error(std::string("Could not map a slab chunk: ") +
+                               std::strerror(errno));
+    }
+  }
+
+  ~SlabChunk() { munmap(addr, length); }
+
+  SlabChunk(SlabChunk const &) = delete;
+  SlabChunk &operator=(SlabChunk const &) = delete;
+  SlabChunk(SlabChunk &&) = delete;
+  SlabChunk &operator=(SlabChunk &&) = delete;
+
+  void *ptr() const { return addr; }
+
+ private:
+  void *addr;
+  size_t const length;
+};
+
+/**
+ * @brief Slabs of all the sizes, so that they can be trimmed at once.
+ */
+class Slabs {
+ public:
+  using Trim = void (*)();
+
+  static void add(Trim const trim) {
+    auto &slabs = instance();
+    std::scoped_lock<Mutex> lock{slabs.mutex};
+    slabs.trims.push_back(trim);
+  }
+
+  static void trim() {
+    auto &slabs = instance();
+    std::scoped_lock<Mutex> lock{slabs.mutex};
+    for (auto const trim : slabs.trims) trim();
+  }
+
+ private:
+  static Slabs &instance() {
+    // Never destroyed, as the slabs.
+    static auto *const slabs = new Slabs;
+    return *slabs;
+  }
+
+  Mutex mutex;
+  std::vector<Trim> trims;
+};
+
+/**
+ * @brief Returns the chunks of the slabs whose slots are all free to the
+ *        system, but for one chunk of slack per slab.
+ *
+ * Meant to be called once idle: the slabs grow back, faulting the pages in
+ * again, on the next burst.
+ */
+inline void trim_slabs() { Slabs::trim(); }
+
+/**
+ * @brief Fixed-size slots carved out of large chunks, which are backed by 2MiB
+ *        hugepages when the system has enough of them free.
+ *
+ * Freed slots are recycled in place (LIFO, so that the most recently used, and
+ * thus cached, slots are reused first) and chunks are only returned to the
+ * system by `trim_slabs`: in steady state, allocating the SKs and PK batches
+ * neither calls into the system allocator nor faults pages, and they are
+ * packed in few TLB entries.
+ *
+ * Slabs are shared by all the types of the same size and alignment. Slots may
+ * be freed by any thread: each thread caches up to `CacheSize` free slots and
+ * only takes the slab's lock to move half of them from or to the shared list.
+ * The application threads that free the SKs they signed with thus do not
+ * contend with the threads that allocate them.
+ */
+template <size_t Size, size_t Alignment>
+class Slab {
+  static size_t constexpr CacheLineSize = 64;
+  static size_t constexpr HugePageSize = 2 << 20;
+  static size_t constexpr SlotAlignment = std::max(Alignment, CacheLineSize);
+  static size_t constexpr Stride = (Size + SlotAlignment - 1) / SlotAlignment * SlotAlignment;
+  // Chunks are made of whole hugepages, at least 4MiB.
+  static size_t constexpr MinChunkSize = 4 << 20;
+  static size_t constexpr ChunkSize =
+      (std::max(Stride, MinChunkSize) + HugePageSize - 1) / HugePageSize * HugePageSize;
+  static_assert(HugePageSize % SlotAlignment == 0);
+  static size_t constexpr CacheSize = 32;
+
+  // Trivially destructible, so that it stays usable while the thread exits.
+  struct Cache {
+    std::array<uint8_t *, CacheSize> slots;
+    size_t size;
+    // 0 until the thread's `ExitGuard` is set up, and once it ran.
+    size_t capacity;
+    bool exited;
+  };
+  static inline thread_local Cache cache{};
+
+  // Gives the slots cached by a thread back to the slab when it exits.
+  struct ExitGuard {
+    ~ExitGuard() {
+      auto &c = cache;
+      c.capacity = 0;
+      c.exited = true;
+      instance().spill(c);
+    }
+  };
+
+ public:
+  static Slab &instance() {
+    // Never destroyed: slots may be freed during static destruction.
+    static auto *const slab = new Slab;
+    return *slab;
+  }
+
+  void *allocate() {
+    auto &c = cache;
+    if (likely(c.size != 0)) return c.slots[--c.size];
+    return refill(c);
+  }
+
+  void deallocate(void *const slot) {
+    auto &c = cache;
+    if (unlikely(c.size == c.capacity)) {
+      set_up(c);
+      spill(c, c.capacity / 2);
+    }
+    if (unlikely(c.capacity == 0)) {
+      std::scoped_lock<Mutex> lock{mutex};
+      recycled.push_back(static_cast<uint8_t *>(slot));
+      return;
+    }
+    c.slots[c.size++] = static_cast<uint8_t *>(slot);
+  }
+
+ private:
+  Slab() {
+    Slabs::add([] { instance().trim(); });
+  }
+
+  static void set_up(Cache &c) {
+    if (c.capacity != 0 || c.exited) return;
+    static thread_local ExitGuard guard;
+    (void)guard;
+    c.capacity = CacheSize;
+  }
+
+  // Fills half of the empty cache of the thread and returns one more slot.
+  void *refill(Cache &c) {
+    set_up(c);
+    std::scoped_lock<Mutex> lock{mutex};
+    while (c.size < c.capacity / 2 && !recycled.empty()) {
+      c.slots[c.size++] = recycled.back();
+      recycled.pop_back();
+    }
+    if (c.size != 0) return c.slots[--c.size];
+    if (!recycled.empty()) {
+      auto *const slot = recycled.back();
+      recycled.pop_back();
+      return slot;
+    }
+    if (next == end) grow();
+    auto *const slot = next;
+    next += Stride;
+    return slot;
+  }
+
+  // Moves the least recently freed slots of the thread to the shared list,
+  // only keeping `keep` of them.
+  void spill(Cache &c, size_t const keep = 0) {
+    if (c.size <= keep) return;
+    auto const moved = c.size - keep;
+    {
+      std::scoped_lock<Mutex> lock{mutex};
+      recycled.insert(recycled.end(), c.slots.begin(), c.slots.begin() + moved);
+    }
+    std::copy(c.slots.begin() + moved, c.slots.begin() + c.size, c.slots.begin());
+    c.size = keep;
+  }
+
+  void trim() {
+    std::scoped_lock<Mutex> lock{mutex};
+    // The last chunk is the one being carved.
+    if (chunks.size() < 3) return;
+    auto const slots_per_chunk = ChunkSize / Stride;
+    std::vector<std::pair<uint8_t *, size_t>> free_slots;
+    for (size_t i = 0; i + 1 < chunks.size(); i++) {
+      free_slots.emplace_back(static_cast<uint8_t *>(chunks[i]->ptr()), 0);
+    }
+    std::sort(free_slots.begin(), free_slots.end());
+    auto const chunk_of = [&](uint8_t *const slot) {
+      auto it = std::upper_bound(free_slots.begin(), free_slots.end(),
+                                 std::make_pair(slot, SIZE_MAX));
+      if (it == free_slots.begin() || slot >= std::prev(it)->first + ChunkSize) {
+        return free_slots.end();
+      }
+      return std::prev(it);
+    };
+    for (auto *const slot : recycled) {
+      if (auto const it = chunk_of(slot); it != free_slots.end()) it->second++;
+    }
+
+    // Chunks are anonymous mappings: dropping them unmaps their pages.
+    std::vector<uint8_t *> trimmed;
+    auto slack = false;
+    for (auto &[chunk, nb_free] : free_slots) {
+      if (nb_free != slots_per_chunk) continue;
+      if (!std::exchange(slack, true)) continue;
+      trimmed.push_back(chunk);
+    }
+    if (trimmed.empty()) return;
+    auto const was_trimmed = [&](uint8_t *const chunk) {
+      return std::find(trimmed.begin(), trimmed.end(), chunk) != trimmed.end();
+    };
+    recycled.erase(std::remove_if(recycled.begin(), recycled.end(),
+                                  [&](uint8_t *const slot) {
+                                    auto const it = chunk_of(slot);
+                                    return it != free_slots.end() && was_trimmed(it->first);
+                                  }),
+                   recycled.end());
+    chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+                                [&](auto const &chunk) {
+                                  return was_trimmed(static_cast<uint8_t *>(chunk->ptr()));
+                                }),
+                 chunks.end());
+    LOGGER_DEBUG(logger, "Released {} chunks of {}B slots.", trimmed.size(), Stride);
+  }
+
+  void grow() {
+    auto hugepages = hugepages_available();
+    std::unique_ptr<SlabChunk> buf;
+    if (hugepages) {
+      try {
+        buf = std::make_unique<SlabChunk>(ChunkSize, true);
+      } catch (std::runtime_error const &) {
+        hugepages = false;
+      }
+    }
+    if (!buf) {
+      buf = std::make_unique<SlabChunk>(ChunkSize, false);
+    }
+    chunks.push_back(std::move(buf));
+    next = static_cast<uint8_t *>(chunks.back()->ptr());
+    end = next + ChunkSize / Stride * Stride;
+    // Fault all the pages in now rather than on the critical path.
+    std::memset(next, 0, ChunkSize);
+    recycled.reserve(chunks.size() * (ChunkSize / Stride));
+    LOGGER_DEBUG(logger, "New {}MiB chunk of {}B slots on {} pages.", ChunkSize >> 20,
+                 Stride, hugepages ? "2MiB" : "4KiB");
+  }
+
+  // Spares a failing reservation when the hugepage pool is obviously short.
+  static bool hugepages_available() {
+    std::ifstream free_hugepages{"/sys/kernel/mm/hugepages/hugepages-2048kB/free_hugepages"};
+    size_t free{0};
+    return (free_hugepages >> free) && free >= ChunkSize / HugePageSize;
+  }
+
+  Mutex mutex;
+  std::vector<std::unique_ptr<SlabChunk>> chunks;
+  uint8_t *next{nullptr};
+  uint8_t *end{nullptr};
+  std::vector<uint8_t *> recycled;
+
+  LOGGER_DECL_INIT(logger, "Dsig::Slab");
+};
+
+/**
+ * @brief Makes `new T`/`delete` of the deriving class `T` go through its slab,
+ *        so that `std::make_unique<T>` recycles the slots.
+ */
+template <typename T>
+struct SlabAllocated {
+  static void *operator new(size_t const size) {
+    if (size != sizeof(T)) throw std::bad_alloc();
+    return Slab<sizeof(T), alignof(T)>::instance().allocate();
+  }
+
+  static void operator delete(void *const ptr) {
+    Slab<sizeof(T), alignof(T)>::instance().deallocate(ptr);
+  }
+};
+
+template <typename T>
+struct SlabDelete {
+  void operator()(T *const ptr) const {
+    ptr->~T();
+    Slab<sizeof(T), alignof(T)>::instance().deallocate(ptr);
+  }
+};
+
+// For the types that cannot derive from `SlabAllocated`.
+template <typename T>
+using SlabPtr = std::unique_ptr<T, SlabDelete<T>>;
+
+template <typename T, typename... Args>
+SlabPtr<T> make_slab(Args &&... args) {
+  auto *const slot = Slab<sizeof(T), alignof(T)>::instance().allocate();
+  try {
+    return SlabPtr<T>{new (slot) T(std::forward<Args>(args)...)};
+  } catch (...) {
+    Slab<sizeof(T), alignof(T)>::instance().deallocate(slot);
+    throw;
+  }
+}
+
+/**
+ * @brief Standard allocator for containers that allocate `N` elements at once
+ *        (e.g., a vector reserved upfront).
+ */
+template <typename T, size_t N>
+struct SlabAllocator {
+  using value_type = T;
+  template <typename U>
+  struct rebind {
+    using other = SlabAllocator<U, N>;
+  };
+
+  SlabAllocator() = default;
+  template <typename U>
+  SlabAllocator(SlabAllocator<U, N> const &) {}
+
+  T *allocate(size_t const n) {
+    if (n != N) throw std::bad_alloc();
+    return static_cast<T *>(Slab<sizeof(T) * N, alignof(T)>::instance().allocate());
+  }
+
+  void deallocate(T *const ptr, size_t const) {
+    Slab<sizeof(T) * N, alignof(T)>::instance().deallocate(ptr);
+  }
+
+  template <typename U>
+  bool operator==(SlabAllocator<U, N> const &) const { return true; }
+  template <typename U>
+  bool operator!=(SlabAllocator<U, N> const &) const { return false; }
+};
+
+}  // namespace dory::DSIG_NS
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include <fmt/core.h>
+
+#include <dory/crypto/hash/blake3.hpp>
+
+#include "export/namespace.hpp"
+#include "inf-crypto/crypto.hpp"
+#include "message.hpp"
+#include "types.hpp"
+#include "util.hpp"
+
+#include "hors.hpp"
+#include "wots.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Verifies a signature without its batch of PKs.
+ *
+ * The Inf signature of the PK batch is checked first. It authenticates
+ * `pk_sig.signed_hash`, i.e., the hash of the HBSS PK, which the revealed
+ * secrets must then hash back to.
+ */
+inline bool slow_verify(InfCrypto &inf, HorsMerkleSignature const &sig,
+                        MsgView const &msg, ProcId const pid) {
+  auto const& pk_hash = sig.pk_sig.signed_hash;
+
+  // 1. Verify the Inf signature.
+  if (!inf.verify(sig.pk_sig, pid)) {
+    fmt::print(stderr, "Invalid Inf batched sig.\n");
+    return false;
+  }
+
+  // 2. Verify that the roots match the signed pk hash.
+  auto hasher = crypto::hash::blake3_init();
+  crypto::hash::blake3_update(hasher, sig.pk_nonce);
+  crypto::hash::blake3_update(hasher, sig.roots);
+  if (crypto::hash::blake3_final(hasher) != pk_hash) {
+    fmt::print(stderr, "Pk roots do not match the signed hash!\n");
+    return false;
+  }
+
+  // 3. For each secret, verify that its proof leads to one of the roots.
+  HorsHash h(pk_hash, sig.nonce, msg);
+  std::array<SecretHash, hors::SecretsPerSignature> hashed_secrets;
+  SecretHasher secret_hasher;
+  for (size_t secret = 0; secret < hors::SecretsPerSignature; secret++) {
+    secret_hasher.push(sig.secretsAndNeighborsHash.at(secret).secret, sig.pk_nonce, h.getSecretIndex(secret), 0, hashed_secrets[secret]);
+  }
+  secret_hasher.flush();
+  for (size_t secret = 0; secret < hors::SecretsPerSignature; secret++) {
+    auto const secret_index = h.getSecretIndex(secret);
+    auto const& hashed_secret = hashed_secrets[secret];
+    auto const neighbor_hashed_secret = sig.secretsAndNeighborsHash.at(secret).neighborHash;
+    std::array<SecretHash, 2> leaf;
+    if (secret_index & 1) {
+      leaf = std::array<SecretHash, 2>{neighbor_hashed_secret, hashed_secret};
+    } else {
+      leaf = std::array<SecretHash, 2>{hashed_secret, neighbor_hashed_secret};
+    }
+    static_assert(sizeof(SecretHash) * 2 >= sizeof(Hash));
+    if (!sig.proofs.at(secret).in_roots(*reinterpret_cast<Hash*>(&leaf), secret_index >> 1, sig.roots)) {
+      fmt::print(stderr, "Pk roots do not match proof #{}!\n", secret);
+      return false;
+    }
+  }
+  return true;
+}
+
+inline bool slow_verify(InfCrypto &inf, HorsCompletedSignature const &sig,
+                        MsgView const &msg, ProcId const pid) {
+  auto const& pk_hash = sig.pk_sig.signed_hash;
+
+  // 1. Verify the Inf signature.
+  if (!inf.verify(sig.pk_sig, pid)) {
+    fmt::print(stderr, "Invalid Inf batched sig.\n");
+    return false;
+  }
+
+  // 2. Verify HORS secrets (i.e., that the right secrets were revealed).
+  auto sig_hashes = sig.fused_secrets;
+
+  HorsHash h(pk_hash, sig.nonce, msg);
+
+  SecretHasher secret_hasher;
+  for (size_t secret = 0; secret < hors::SecretsPerSignature; secret++) {
+    auto const secret_index = h.getSecretIndex(secret);
+    secret_hasher.push(sig.fused_secrets.at(secret_index), sig.pk_nonce, secret_index, 0, sig_hashes.at(secret_index));
+  }
+  secret_hasher.flush();
+
+  auto hasher = crypto::hash::blake3_init();
+  crypto::hash::blake3_update(hasher, sig.pk_nonce);
+  crypto::hash::blake3_update(hasher, sig_hashes);
+  return crypto::hash::blake3_final(hasher) == pk_hash;
+}
+
+inline bool slow_verify(InfCrypto &inf, WotsSignature const &sig,
+                        MsgView const &msg, ProcId const pid) {
+  auto const& pk_hash = sig.pk_sig.signed_hash;
+
+  // 1. Verify the Inf signature.
+  if (!inf.verify(sig.pk_sig, pid)) {
+    fmt::print(stderr, "Invalid Inf batched sig.\n");
+    return false;
+  }
+
+  // 2. Verify WOTS secrets (i.e., that the right secrets were revealed).
+  auto sig_hashes = sig.secrets;
+
+  WotsHash h(pk_hash, sig.nonce, msg);
+
+  SecretHasher secret_hasher;
+  for (size_t d = 0; d + 1 < SecretsDepth; d++) {
+    for (size_t secret = 0; secret < wots::SecretsPerSignature; secret++) {
+      if (h.getSecretDepth(secret) <= d) {
+        secret_hasher.push(sig_hashes[secret], sig.pk_nonce, secret, d, sig_hashes[secret]);
+      }
+    }
+    secret_hasher.flush();
+  }
+
+  auto hasher = crypto::hash::blake3_init();
+  crypto::hash::blake3_update(hasher, sig.pk_nonce);
+  crypto::hash::blake3_update(hasher, sig_hashes);
+  return crypto::hash::blake3_final(hasher) == pk_hash;
+}
+
+}  // namespace dory::DSIG_NS
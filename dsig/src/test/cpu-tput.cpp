@@ -1,10 +1,14 @@
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <deque>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <stdexcept>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <fmt/chrono.h>
 #include <fmt/core.h>
@@ -15,6 +19,7 @@
 #include "../sk/pipeline.hpp"
 #include "../pk/pk.hpp"
 #include "../inf-crypto/crypto.hpp"
+#include "../slow-verify.hpp"
 #include "../workers.hpp"
 
 using namespace dory::dsig;
@@ -26,50 +31,141 @@ class BenchmarkSkPipeline: SkPipeline {
     for (auto &sk : batch->sks) {
       auto const seed{seed_generator.generate()};
       sk = std::make_unique<SecretKey>(seed, workers);
-      while (sk->state != SecretKey::Initialized);
     }
     return batch;
   }
 
+  static void wait_initialized(SigningBatch const& batch) {
+    for (auto const& sk : batch.sks) {
+      while (sk->state != SecretKey::Initialized);
+    }
+  }
+
  public:
-  BenchmarkSkPipeline(InfCrypto &inf, Workers &workers) : SkPipeline{*reinterpret_cast<Network*>(0), inf, workers} { }
+  BenchmarkSkPipeline(InfCrypto &inf, Workers &workers) : SkPipeline{*reinterpret_cast<Network*>(0), inf, workers, inf.myId()} { }
 
   struct Results {
     constexpr Results() noexcept {};
-    std::chrono::nanoseconds sk_gen{0}, pk_sign{0}, pk_check{0}, sign{0}, verify{0};
+    std::chrono::nanoseconds sk_gen{0}, pk_sign{0}, pk_check{0}, sign{0}, verify{0}, verify_many{0}, slow_verify{0};
+    // Extraction of the HORS Merkle proofs of a signature, by walking the tree
+    // vs gathering them from the precomputed table.
+    std::chrono::nanoseconds proofs_walk{0}, proofs_gather{0};
   };
 
-  Results run(size_t const iters) {
+  // Extracts the proofs of the `h` secrets both ways, as `SecretKey::sign`
+  // would (with or without `PrecomputedHorsProofs`).
+  template <typename MsgHash>
+  static void time_proofs(HorsMerkleTree const& tree, SecretKey::HorsProofs const& table,
+                          MsgHash const& h, Results& res) {
+    HorsMerkleSignature sig;
+    auto const walk_start = std::chrono::steady_clock::now();
+    sig.roots = tree.roots();
+    for (size_t i = 0; i < SecretsPerSignature; i++) {
+      sig.proofs[i] = HorsMerkleProof(tree, h.getSecretIndex(i) >> 1);
+    }
+    res.proofs_walk += std::chrono::steady_clock::now() - walk_start - NowOverhead;
+    dory::dsig::prefetch(sig);
+    auto const gather_start = std::chrono::steady_clock::now();
+    sig.roots = table.roots;
+    for (size_t i = 0; i < SecretsPerSignature; i++) {
+      sig.proofs[i] = table.slots[h.getSecretIndex(i) >> 1].proof;
+    }
+    res.proofs_gather += std::chrono::steady_clock::now() - gather_start - NowOverhead;
+    volatile auto const sink = sig.proofs.back().path.back()[0];
+  }
+
+  // With `slow`, signatures are also verified without their PKs.
+  Results run(size_t const iters, bool const slow) {
     if (iters % SigningBatch::Size != 0)
       throw std::runtime_error("`iters` must be a multiple of `SigningBatch::Size`");
 
+    // Process as many batches at once as there are workers so that they are
+    // all kept busy.
+    size_t const batches_per_round = std::max(workers.size(), 1ul);
+
     Results res;
-    for (size_t i = 0; i < iters; i += SigningBatch::Size) {
+    for (size_t i = 0; i < iters;) {
+      auto const batches = std::min(batches_per_round, (iters - i) / SigningBatch::Size);
+      i += batches * SigningBatch::Size;
+
       auto const sk_gen_start = std::chrono::steady_clock::now();
-      auto sk_batch = gen_sk_batch();
+      std::vector<std::unique_ptr<SigningBatch>> sk_batches;
+      for (size_t b = 0; b < batches; b++) {
+        sk_batches.emplace_back(gen_sk_batch());
+      }
+      for (auto const& sk_batch : sk_batches) {
+        wait_initialized(*sk_batch);
+      }
       res.sk_gen += std::chrono::steady_clock::now() - sk_gen_start - NowOverhead;
 
       auto const pk_sign_start = std::chrono::steady_clock::now();
-      sk_batch->schedule(workers, inf_crypto);
-      while (sk_batch->state != SigningBatch::Computed);
+      for (auto& sk_batch : sk_batches) {
+        sk_batch->schedule(workers, inf_crypto, signer);
+      }
+      for (auto const& sk_batch : sk_batches) {
+        while (sk_batch->state != SigningBatch::Computed);
+      }
       res.pk_sign += std::chrono::steady_clock::now() - pk_sign_start - NowOverhead;
 
       auto const pk_check_start = std::chrono::steady_clock::now();
-      BgPublicKeys pks{workers, inf_crypto, 1, sk_batch->to_send};
-      while (pks.state != BgPublicKeys::Ready);
+      std::vector<std::unique_ptr<BgPublicKeys>> batches_pks;
+      for (auto const& sk_batch : sk_batches) {
+        batches_pks.emplace_back(std::make_unique<BgPublicKeys>(workers, *sk_batch->to_send));
+      }
+      std::vector<BgPublicKeys*> computed;
+      for (auto const& pks : batches_pks) {
+        while (pks->state != BgPublicKeys::Computed);
+        computed.push_back(pks.get());
+      }
+      std::vector<ProcId> srcs(computed.size(), 1);
+      BgPublicKeys::check_root_sigs(inf_crypto, computed.data(), srcs.data(), computed.size());
+      for (auto const& pks : batches_pks) {
+        while (pks->state != BgPublicKeys::Ready);
+      }
       res.pk_check += std::chrono::steady_clock::now() - pk_check_start - NowOverhead;
 
       std::array<uint8_t, 8> msg = {0xC0, 0xCA, 0xC0, 0x1A, 0xDE, 0xAD, 0xBE, 0xEF};
       static_assert(msg.size() >= sizeof(size_t));
 
-      for (size_t j = 0; j < SigningBatch::Size; j++, ++*reinterpret_cast<size_t*>(&msg)) {
-        auto& sk = sk_batch->sks.at(j);
-        auto const sign_start = std::chrono::steady_clock::now();
-        auto const sig = sk->sign(msg.data(), msg.size());
-        res.sign += std::chrono::steady_clock::now() - sign_start - NowOverhead;
-        auto const verify_start = std::chrono::steady_clock::now();
-        volatile auto const valid = pks.verify(sig, msg.data(), msg.size());
-        res.verify += std::chrono::steady_clock::now() - verify_start - NowOverhead;
+      std::vector<Signature> sigs(SigningBatch::Size);
+      std::vector<std::array<uint8_t, 8>> msgs(SigningBatch::Size);
+      std::vector<VerifyRequest> reqs;
+      std::vector<size_t> idxs(SigningBatch::Size);
+      std::iota(idxs.begin(), idxs.end(), 0);
+      bool valid_many[SigningBatch::Size];
+      for (size_t b = 0; b < batches; b++) {
+        auto& sk_batch = sk_batches.at(b);
+        auto& pks = *batches_pks.at(b);
+        reqs.clear();
+        std::unique_ptr<HorsMerkleTree> tree;
+        std::unique_ptr<SecretKey::HorsProofs> table;
+        if constexpr (HbssScheme == HorsMerkle) {
+          tree = std::make_unique<HorsMerkleTree>(sk_batch->sks.front()->getPk());
+          table = std::make_unique<SecretKey::HorsProofs>(*tree);
+        }
+        for (size_t j = 0; j < SigningBatch::Size; j++, ++*reinterpret_cast<size_t*>(&msg)) {
+          auto& sk = sk_batch->sks.at(j);
+          auto const sign_start = std::chrono::steady_clock::now();
+          auto const sig = sk->sign(MsgView(msg.data(), msg.size()));
+          res.sign += std::chrono::steady_clock::now() - sign_start - NowOverhead;
+          if constexpr (HbssScheme == HorsMerkle) {
+            time_proofs(*tree, *table, sk->hash(MsgView(msg.data(), msg.size())), res);
+          }
+          auto const verify_start = std::chrono::steady_clock::now();
+          volatile auto const valid = pks.verify(sig, MsgView(msg.data(), msg.size()));
+          res.verify += std::chrono::steady_clock::now() - verify_start - NowOverhead;
+          if (slow) {
+            auto const slow_verify_start = std::chrono::steady_clock::now();
+            volatile auto const slow_valid = dory::dsig::slow_verify(inf_crypto, sig, MsgView(msg.data(), msg.size()), 1);
+            res.slow_verify += std::chrono::steady_clock::now() - slow_verify_start - NowOverhead;
+          }
+          sigs[j] = sig;
+          msgs[j] = msg;
+          reqs.push_back({&sigs[j], msgs[j].data(), msgs[j].size(), 1});
+        }
+        auto const verify_many_start = std::chrono::steady_clock::now();
+        pks.verify_many(reqs.data(), idxs.data(), reqs.size(), valid_many);
+        res.verify_many += std::chrono::steady_clock::now() - verify_many_start - NowOverhead;
       }
     }
     return res;
@@ -103,6 +199,8 @@ int main(int argc, char *argv[]) {
   bool get_help = false;
   size_t iters = 2048 << 10;
   bool eddsa = false;
+  bool slow = false;
+  std::vector<size_t> worker_counts;
 
   cli.add_argument(lyra::help(get_help))
       .add_argument(
@@ -114,7 +212,17 @@ int main(int argc, char *argv[]) {
           lyra::opt(eddsa)
               .name("-e")
               .name("--eddsa")
-              .help("Benchmark EdDSA instead of Dsig"));
+              .help("Benchmark EdDSA instead of Dsig"))
+      .add_argument(
+          lyra::opt(slow)
+              .name("-s")
+              .name("--slow")
+              .help("Also benchmark the slow path (verification without PKs)"))
+      .add_argument(
+          lyra::opt(worker_counts, "workers")
+              .name("-w")
+              .name("--workers")
+              .help("Number of background workers (repeat to measure scaling, 0: inline)"));
 
   auto const result = cli.parse({argc, argv});
 
@@ -128,20 +236,49 @@ int main(int argc, char *argv[]) {
 
 
   InfCrypto inf{1, {1}};
-  Workers workers;
   auto const gop = iters * 1000 * 1000 * 1000;
   if (!eddsa) {
+    if (worker_counts.empty()) {
+      worker_counts.push_back(0);
+    }
     fmt::print("[SECRETS/SK={}, SK={}B, Signature={}B ITERS={}]\n",
               SecretsPerSecretKey, sizeof(SecretKey), sizeof(Signature), iters);
-    BenchmarkSkPipeline benchmark{inf, workers};
-    auto const res = benchmark.run(iters);
-    fmt::print("[DSIG][BG][SK][GEN] tput: {} sk/s latency: {} ns\n", gop / res.sk_gen.count(), res.sk_gen.count() / iters);
-    fmt::print("[DSIG][BG][PK][SIGN] tput: {} pk/s latency: {} ns\n", gop / res.pk_sign.count(), res.pk_sign.count() / iters);
-    fmt::print("[DSIG][BG][PK][CHECK] tput: {} pk/s latency: {} ns\n", gop / res.pk_check.count(), res.pk_check.count() / iters);
-    fmt::print("[DSIG][FG][SIGN] tput: {} sig/s latency: {} ns\n", gop / res.sign.count(), res.sign.count() / iters);
-    fmt::print("[DSIG][FG][VERIF] tput: {} sig/s latency: {} ns\n", gop / res.verify.count(), res.verify.count() / iters);
-    fmt::print("[DSIG][TOTAL][SIGN] tput: {} sig/s latency: {} ns\n", gop / (res.sk_gen + res.pk_sign + res.sign).count(), (res.sk_gen + res.pk_sign + res.sign).count() / iters);
-    fmt::print("[DSIG][TOTAL][VERIF] tput: {} sig/s latency: {} ns\n", gop / (res.pk_check + res.verify).count(), (res.pk_check + res.verify).count() / iters);
+    std::vector<std::pair<size_t, BenchmarkSkPipeline::Results>> scaling;
+    for (auto const nb_workers : worker_counts) {
+      fmt::print("[WORKERS={}]\n", nb_workers);
+      Workers workers{nb_workers};
+      BenchmarkSkPipeline benchmark{inf, workers};
+      auto const res = benchmark.run(iters, slow);
+      scaling.emplace_back(nb_workers, res);
+      fmt::print("[DSIG][BG][SK][GEN] tput: {} sk/s latency: {} ns\n", gop / res.sk_gen.count(), res.sk_gen.count() / iters);
+      fmt::print("[DSIG][BG][PK][SIGN] tput: {} pk/s latency: {} ns\n", gop / res.pk_sign.count(), res.pk_sign.count() / iters);
+      fmt::print("[DSIG][BG][PK][CHECK] tput: {} pk/s latency: {} ns\n", gop / res.pk_check.count(), res.pk_check.count() / iters);
+      fmt::print("[DSIG][FG][SIGN] tput: {} sig/s latency: {} ns\n", gop / res.sign.count(), res.sign.count() / iters);
+      if constexpr (HbssScheme == HorsMerkle) {
+        fmt::print("[DSIG][FG][SIGN][PROOFS] tree-walk: {} ns precomputed: {} ns speedup: {:.2f}x (SK layout: {})\n",
+                   res.proofs_walk.count() / iters, res.proofs_gather.count() / iters,
+                   static_cast<double>(res.proofs_walk.count()) / static_cast<double>(res.proofs_gather.count()),
+                   SecretKey::PrecomputedHorsProofs ? "precomputed" : "tree");
+      }
+      fmt::print("[DSIG][FG][VERIF] tput: {} sig/s latency: {} ns\n", gop / res.verify.count(), res.verify.count() / iters);
+      fmt::print("[DSIG][FG][VERIF][MANY] tput: {} sig/s latency: {} ns\n", gop / res.verify_many.count(), res.verify_many.count() / iters);
+      if (slow) {
+        fmt::print("[DSIG][FG][VERIF][SLOW] tput: {} sig/s latency: {} ns slowdown vs fast: {:.2f}x\n", gop / res.slow_verify.count(), res.slow_verify.count() / iters,
+                   static_cast<double>(res.slow_verify.count()) / static_cast<double>(res.verify.count()));
+      }
+      fmt::print("[DSIG][TOTAL][SIGN] tput: {} sig/s latency: {} ns\n", gop / (res.sk_gen + res.pk_sign + res.sign).count(), (res.sk_gen + res.pk_sign + res.sign).count() / iters);
+      fmt::print("[DSIG][TOTAL][VERIF] tput: {} sig/s latency: {} ns\n", gop / (res.pk_check + res.verify).count(), (res.pk_check + res.verify).count() / iters);
+    }
+    if (scaling.size() > 1) {
+      auto const& [base_workers, base] = scaling.front();
+      auto const base_bg = base.sk_gen + base.pk_sign;
+      for (auto const& [nb_workers, res] : scaling) {
+        auto const bg = res.sk_gen + res.pk_sign;
+        fmt::print("[DSIG][SCALING] workers: {} bg tput: {} sk/s pk check tput: {} pk/s speedup vs {} workers: {:.2f}x\n",
+                   nb_workers, gop / bg.count(), gop / res.pk_check.count(), base_workers,
+                   static_cast<double>(base_bg.count()) / static_cast<double>(bg.count()));
+      }
+    }
   } else {
     auto const eddsa_res = eddsa_bench(inf, iters);
     fmt::print("[EDDSA][SIGN] tput: {} sig/s latency: {} ns\n", gop / eddsa_res.sign.count(), eddsa_res.sign.count() / iters);
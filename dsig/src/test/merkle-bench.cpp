@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include <fmt/core.h>
+
+#include "../merkle.hpp"
+
+using namespace dory::dsig;
+using Clock = std::chrono::steady_clock;
+
+// Tree sizes are template parameters: the scheme the binary is configured with
+// does not matter. Each tree size is built enough times to hash about that many nodes.
+static size_t constexpr NodesPerRun = 1 << 22;
+
+/**
+ * @brief Builds a `MerkleTree<LogNbLeaves, LogNbRoots>` one parent at a time
+ *        and level by level, checks that both agree and reports their latency.
+ */
+template <size_t LogNbLeaves, size_t LogNbRoots = 0>
+static void bench(std::string_view const usage) {
+  using Tree = MerkleTree<LogNbLeaves, LogNbRoots>;
+  auto leaves = std::make_unique<typename Tree::Leaves>();
+  for (size_t i = 0; i < leaves->size(); i++) {
+    auto &leaf = leaves->at(i);
+    std::fill(leaf.begin(), leaf.end(), static_cast<uint8_t>(i));
+    *reinterpret_cast<uint32_t *>(leaf.data()) = static_cast<uint32_t>(i);
+  }
+  auto sequential = std::make_unique<Tree>(*leaves, false);
+  auto parallel = std::make_unique<Tree>(*leaves, false);
+  auto const runs = std::max(NodesPerRun / Tree::NbLeaves, 1ul);
+
+  auto const seq_start = Clock::now();
+  for (size_t r = 0; r < runs; r++) {
+    sequential->compute_sequential();
+  }
+  auto const seq = (Clock::now() - seq_start) / runs;
+
+  auto const par_start = Clock::now();
+  for (size_t r = 0; r < runs; r++) {
+    parallel->compute();
+  }
+  auto const par = (Clock::now() - par_start) / runs;
+
+  if (sequential->roots() != parallel->roots()) {
+    throw std::runtime_error(fmt::format(
+        "Roots mismatch for 2^{} leaves and 2^{} roots", LogNbLeaves, LogNbRoots));
+  }
+
+  fmt::print(
+      "[MERKLE][LEAVES=2^{}][ROOTS=2^{}] {}: sequential: {} ns, "
+      "level-parallel: {} ns, speedup: {:.2f}x\n",
+      LogNbLeaves, LogNbRoots, usage,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(seq).count(),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(par).count(),
+      static_cast<double>(seq.count()) / static_cast<double>(par.count()));
+}
+
+int main() {
+  // Batches of Inf signatures and of background PKs (all schemes), for each
+  // LOG_INF_BATCH_SIZE that is built.
+  bench<1>("inf batch");
+  bench<2>("inf batch");
+  bench<3>("inf batch");
+  bench<4>("inf batch");
+  bench<5>("inf batch");
+  bench<6>("inf batch");
+  bench<7>("inf batch");
+  bench<8>("inf batch");
+  bench<9>("inf batch");
+  bench<10>("inf batch");
+  bench<11>("inf batch");
+  bench<12>("inf batch");
+  bench<13>("inf batch");
+  bench<14>("inf batch");
+  bench<15>("inf batch");
+  bench<16>("inf batch");
+
+  // Merkle HORS keys, for each supported HORS_SECRETS_PER_SIGNATURE.
+  bench<18, 3>("hors k=8");
+  bench<17, 4>("hors k=9");
+  bench<16, 4>("hors k=10");
+  bench<15, 4>("hors k=11");
+  bench<14, 4>("hors k=12");
+  bench<13, 4>("hors k=13");
+  bench<11, 4>("hors k=16");
+  bench<10, 5>("hors k=19");
+  bench<9, 5>("hors k=24");
+  bench<8, 5>("hors k=32");
+  bench<7, 6>("hors k=64");
+
+  fmt::print("###DONE###\n");
+  return 0;
+}
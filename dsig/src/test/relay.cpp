@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <lyra/lyra.hpp>
+
+#include "../relay.hpp"
+
+using namespace dory::dsig;
+
+/**
+ * @brief Disseminates PK batches over an in-process transport that mimics the
+ *        RCs of the Network: one FIFO per process, in which messages keep the
+ *        signer of the batch they carry.
+ *
+ * Every process builds its own `RelayTree`, as it would in the Network, and
+ * forwards what it receives before checking it. An optional relay tampers with
+ * the batches it forwards: the receivers reject them as they would on an
+ * invalid root signature, but keep forwarding them.
+ */
+class SimulatedTransport {
+ public:
+  struct Message {
+    ProcId signer;
+    uint64_t batch;
+    bool forged;
+    size_t hops;
+  };
+
+  struct Node {
+    Node(ProcId const id, std::vector<ProcId> const &signers,
+         std::vector<ProcId> const &verifiers, size_t const fanout)
+        : tree{id, signers, verifiers, fanout} {}
+
+    RelayTree tree;
+    std::deque<Message> inbox;
+    size_t egress{0};
+    // Per signer, how many times each batch was accepted.
+    std::map<ProcId, std::map<uint64_t, size_t>> accepted;
+    size_t rejected{0};
+  };
+
+  SimulatedTransport(std::vector<ProcId> const &signers,
+                     std::vector<ProcId> const &verifiers, size_t const fanout,
+                     ProcId const tamperer)
+      : tamperer{tamperer} {
+    std::vector<ProcId> ids = signers;
+    ids.insert(ids.end(), verifiers.begin(), verifiers.end());
+    for (auto const id : ids) {
+      nodes.try_emplace(id, id, signers, verifiers, fanout);
+    }
+  }
+
+  void send(ProcId const signer, uint64_t const batch) {
+    forward(signer, Message{signer, batch, false, 0});
+  }
+
+  // Delivers messages until all the inboxes are empty.
+  void run() {
+    for (bool idle = false; !idle;) {
+      idle = true;
+      for (auto &[id, node] : nodes) {
+        if (node.inbox.empty()) continue;
+        idle = false;
+        auto msg = node.inbox.front();
+        node.inbox.pop_front();
+        max_hops = std::max(max_hops, msg.hops);
+        // Forward first, as the Network does, then check.
+        auto relayed = msg;
+        if (id == tamperer) relayed.forged = true;
+        forward(id, relayed);
+        if (msg.forged) {
+          node.rejected++;
+        } else {
+          node.accepted[msg.signer][msg.batch]++;
+        }
+      }
+    }
+  }
+
+  Node const &node(ProcId const id) const { return nodes.at(id); }
+  size_t depth() const { return max_hops; }
+
+ private:
+  void forward(ProcId const from, Message msg) {
+    auto &node = nodes.at(from);
+    msg.hops++;
+    for (auto const to : node.tree.targets(msg.signer)) {
+      nodes.at(to).inbox.push_back(msg);
+      node.egress++;
+    }
+  }
+
+  ProcId tamperer;
+  std::map<ProcId, Node> nodes;
+  size_t max_hops{0};
+};
+
+int main(int argc, char *argv[]) {
+  lyra::cli cli;
+
+  bool get_help = false;
+  int nb_signers = 1;
+  int nb_verifiers = 64;
+  std::vector<size_t> fanouts;
+  size_t batches = 128;
+  int tamperer = 0;
+
+  cli.add_argument(lyra::help(get_help))
+      .add_argument(lyra::opt(nb_signers, "signers")
+                        .name("-s")
+                        .name("--signers")
+                        .help("Number of signers (ids 1..s)"))
+      .add_argument(lyra::opt(nb_verifiers, "verifiers")
+                        .name("-v")
+                        .name("--verifiers")
+                        .help("Number of verifiers (ids following the signers)"))
+      .add_argument(lyra::opt(fanouts, "fanout")
+                        .name("-k")
+                        .name("--fanout")
+                        .help("Relay fanout, 0: direct (repeat to compare)"))
+      .add_argument(lyra::opt(batches, "batches")
+                        .name("-b")
+                        .name("--batches")
+                        .help("PK batches sent by each signer"))
+      .add_argument(lyra::opt(tamperer, "tamperer")
+                        .name("-t")
+                        .name("--tamperer")
+                        .help("Id of a relay that forges the batches it forwards"));
+
+  auto const result = cli.parse({argc, argv});
+
+  if (get_help) {
+    std::cout << cli;
+    return 0;
+  }
+
+  if (!result)
+    throw std::runtime_error("Error in command line: " + result.errorMessage());
+
+  if (nb_signers < 1 || nb_verifiers < 1)
+    throw std::runtime_error("There must be at least one signer and one verifier.");
+
+  if (fanouts.empty()) {
+    fanouts = {0, 2, 4, 8};
+  }
+
+  std::vector<ProcId> signers, verifiers;
+  for (ProcId id = 1; id <= nb_signers; id++) signers.push_back(id);
+  for (ProcId id = nb_signers + 1; id <= nb_signers + nb_verifiers; id++) verifiers.push_back(id);
+
+  bool ok = true;
+  for (auto const fanout : fanouts) {
+    SimulatedTransport transport{signers, verifiers, fanout, tamperer};
+    for (uint64_t batch = 0; batch < batches; batch++) {
+      for (auto const signer : signers) {
+        transport.send(signer, batch);
+      }
+    }
+    transport.run();
+
+    // Without a tamperer, every verifier must accept each batch exactly once.
+    size_t missing{0}, duplicated{0}, rejected{0};
+    size_t max_relay_egress{0};
+    for (auto const id : verifiers) {
+      auto const &node = transport.node(id);
+      rejected += node.rejected;
+      max_relay_egress = std::max(max_relay_egress, node.egress);
+      for (auto const signer : signers) {
+        if (signer == id) continue;
+        auto const it = node.accepted.find(signer);
+        for (uint64_t batch = 0; batch < batches; batch++) {
+          size_t times = 0;
+          if (it != node.accepted.end()) {
+            auto const b = it->second.find(batch);
+            times = b == it->second.end() ? 0 : b->second;
+          }
+          missing += times == 0;
+          duplicated += times > 1;
+        }
+      }
+    }
+    size_t max_signer_egress{0};
+    for (auto const id : signers) {
+      max_signer_egress = std::max(max_signer_egress, transport.node(id).egress);
+    }
+
+    fmt::print(
+        "[RELAY][FANOUT={}] signer egress: {} msg/batch, max relay egress: {} "
+        "msg/batch, depth: {}, missing: {}, duplicated: {}, rejected: {}\n",
+        fanout, max_signer_egress / batches, max_relay_egress / batches,
+        transport.depth(), missing, duplicated, rejected);
+    if (duplicated != 0 || (tamperer == 0 && (missing != 0 || rejected != 0))) {
+      fmt::print("[RELAY][FANOUT={}] FAILED\n", fanout);
+      ok = false;
+    }
+  }
+
+  fmt::print("###DONE###\n");
+  return ok ? 0 : 1;
+}
@@ -247,6 +247,8 @@ int main(int argc, char* argv[]) {
 
   std::vector<ProcId> signers;
   std::vector<ProcId> verifiers;
+  ProcId first_signer = 0;
+  ProcId last_signer = -1;
 
   cli.add_argument(lyra::help(get_help))
       .add_argument(lyra::opt(scheme, "dsig,sodium,dalek,none")
@@ -260,7 +262,6 @@ int main(int argc, char* argv[]) {
                         .name("--local-id")
                         .help("ID of the present process"))
       .add_argument(lyra::opt(signers, "signers")
-                        .required()
                         .name("-s")
                         .name("--signer")
                         .help("ID of one of the signers"))
@@ -269,6 +270,12 @@ int main(int argc, char* argv[]) {
                         .name("-v")
                         .name("--verifiers")
                         .help("ID of one of the verifiers"))
+      .add_argument(lyra::opt(first_signer, "first")
+                        .name("--first-signer")
+                        .help("First ID of a range of signers (e.g., clients)"))
+      .add_argument(lyra::opt(last_signer, "last")
+                        .name("--last-signer")
+                        .help("Last ID (included) of a range of signers"))
       .add_argument(
           lyra::opt(pings, "pings").name("-p").name("--pings").help("Pings"))
       .add_argument(lyra::opt(msg_size, "msg_size")
@@ -312,6 +319,13 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  for (ProcId id = first_signer; id <= last_signer; id++) {
+    signers.push_back(id);
+  }
+  if (signers.empty()) {
+    throw std::runtime_error("No signer given!");
+  }
+
   for (auto const& signer : signers) {
     if (std::find(verifiers.begin(), verifiers.end(), signer) !=
         verifiers.end()) {
@@ -417,6 +431,33 @@ int main(int argc, char* argv[]) {
           pings * 1000 * 1000 * 1000 / duration.count());
     }
   }
+  if (role == Verifier && !timed_out) {
+    fmt::print(
+        "[Verifier={}/Path={}/Signers={}] verify throughput: {} sig/s\n",
+        local_id, to_string(path), signers.size(),
+        pings * signers.size() * 1000 * 1000 * 1000 / duration.count());
+    if (scheme == "dsig") {
+      auto const stats = dsig->verify_stats();
+      fmt::print(
+          "[Verifier={}/Signers={}] verifications fast: {} waited: {} slow: {}\n",
+          local_id, signers.size(), stats.fast, stats.waited, stats.slow);
+    }
+  }
+  if (role == Signer && scheme == "dsig") {
+    auto const send = dsig->bg_send_stats();
+    if (send.batches != 0) {
+      fmt::print(
+          "[Signer={}/Verifiers={}] bg send cpu: {} ns/batch over {} batches\n",
+          local_id, verifiers.size(), send.cpu.count() / send.batches,
+          send.batches);
+    }
+  }
+  if (scheme == "dsig") {
+    auto const send = dsig->bg_send_stats();
+    if (send.forwarded != 0) {
+      fmt::print("[Proc={}] relayed {} PK batches\n", local_id, send.forwarded);
+    }
+  }
 
   fmt::print("###DONE###\n");
   return timed_out ? 1 : 0;
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/core.h>
+#include <lyra/lyra.hpp>
+
+#include <dory/memstore/store.hpp>
+#include <dory/shared/pinning.hpp>
+
+#include "../dsig.hpp"
+
+using namespace dory;
+using namespace dsig;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Signs bursts of messages from `active` threads of a pool and reports
+ *        the distribution of the sign latencies.
+ *
+ * All the threads of the pool register to Dsig upfront so that the SKs are
+ * spread evenly among them. With a `batch` above 1, threads sign via
+ * `sign_many` and each signature is accounted the average latency of its batch.
+ */
+class SigningThreads {
+ public:
+  SigningThreads(Dsig &dsig, size_t const nb_threads, size_t const batch,
+                 std::vector<int> const &cores)
+      : dsig{dsig}, batch{batch}, latencies(nb_threads) {
+    for (size_t i = 0; i < nb_threads; i++) {
+      threads.emplace_back([this, i] { run(i); });
+      set_thread_name(threads.back(), fmt::format("signer{}", i).c_str());
+      if (i < cores.size()) {
+        pin_thread_to_core(threads.back(), cores.at(i));
+      }
+    }
+    while (registered != nb_threads);
+  }
+
+  ~SigningThreads() {
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  std::vector<std::chrono::nanoseconds> burst(size_t const active, size_t const sigs) {
+    for (size_t i = 0; i < active; i++) {
+      latencies.at(i).clear();
+      latencies.at(i).reserve(sigs);
+    }
+    done = 0;
+    burst_sigs = sigs;
+    active_threads = active;
+    round++;
+    while (done != active);
+
+    std::vector<std::chrono::nanoseconds> all;
+    for (size_t i = 0; i < active; i++) {
+      all.insert(all.end(), latencies.at(i).begin(), latencies.at(i).end());
+    }
+    return all;
+  }
+
+ private:
+  void run(size_t const index) {
+    // Registers this thread to Dsig.
+    dsig.prefetch_sk();
+    registered++;
+
+    std::vector<Signature> sigs(batch);
+    std::vector<std::array<uint8_t, 8>> msgs(
+        batch, {0xC0, 0xCA, 0xC0, 0x1A, 0xDE, 0xAD, 0xBE, 0xEF});
+    std::vector<SignRequest> reqs;
+    for (size_t i = 0; i < batch; i++) {
+      reqs.push_back({&sigs[i], msgs[i].data(), msgs[i].size()});
+    }
+    size_t seen_round = 0;
+    while (!stop) {
+      if (round == seen_round) continue;
+      seen_round = round;
+      if (index >= active_threads) continue;
+      auto &lat = latencies.at(index);
+      for (size_t i = 0; i < burst_sigs; i += batch) {
+        auto const nb = std::min(batch, burst_sigs - i);
+        for (size_t j = 0; j < nb; j++) {
+          ++*reinterpret_cast<size_t *>(msgs[j].data());
+        }
+        auto const start = Clock::now();
+        if (batch == 1) {
+          dsig.sign(sigs.front(), msgs.front().data(), msgs.front().size());
+        } else {
+          dsig.sign_many(reqs.data(), nb);
+        }
+        auto const per_sig = (Clock::now() - start) / nb;
+        lat.insert(lat.end(), nb, per_sig);
+      }
+      done++;
+    }
+  }
+
+  Dsig &dsig;
+  size_t const batch;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<std::chrono::nanoseconds>> latencies;
+  std::atomic<size_t> registered{0};
+  std::atomic<size_t> round{0};
+  std::atomic<size_t> active_threads{0};
+  std::atomic<size_t> burst_sigs{0};
+  std::atomic<size_t> done{0};
+  std::atomic<bool> stop{false};
+};
+
+static std::chrono::nanoseconds percentile(
+    std::vector<std::chrono::nanoseconds> const &sorted, double const perc) {
+  auto const idx = static_cast<size_t>(static_cast<double>(sorted.size() - 1) * perc / 100.);
+  return sorted.at(idx);
+}
+
+int main(int argc, char *argv[]) {
+  fmt::print("Build Time: {}\n", BINARY_BUILD_TIME);
+
+  lyra::cli cli;
+  bool get_help = false;
+  int local_id;
+  size_t nb_procs = 2;
+  size_t rounds = 1024;
+  size_t batch = 1;
+  std::vector<size_t> thread_counts;
+  std::vector<int> cores;
+
+  cli.add_argument(lyra::help(get_help))
+      .add_argument(lyra::opt(local_id, "id")
+                        .required()
+                        .name("-l")
+                        .name("--local-id")
+                        .help("ID of the present process"))
+      .add_argument(lyra::opt(nb_procs, "procs")
+                        .name("-n")
+                        .name("--nb-procs")
+                        .help("Number of processes in the DSIG_CONFIG"))
+      .add_argument(lyra::opt(thread_counts, "threads")
+                        .name("-t")
+                        .name("--threads")
+                        .help("Number of signing threads (repeat to measure scaling)"))
+      .add_argument(lyra::opt(rounds, "rounds")
+                        .name("-r")
+                        .name("--rounds")
+                        .help("Number of signing bursts per thread count"))
+      .add_argument(lyra::opt(batch, "batch")
+                        .name("-b")
+                        .name("--batch")
+                        .help("Number of messages per sign_many call (1: sign)"))
+      .add_argument(lyra::opt(cores, "cores")
+                        .name("-c")
+                        .name("--core")
+                        .help("Core to pin the next signing thread to"));
+
+  auto result = cli.parse({argc, argv});
+
+  if (get_help) {
+    std::cout << cli;
+    return 0;
+  }
+
+  if (!result) {
+    std::cerr << "Error in command line: " << result.errorMessage()
+              << std::endl;
+    return 1;
+  }
+
+  if (thread_counts.empty()) {
+    thread_counts = {1, 2, 4, 8};
+  }
+  auto const max_threads = *std::max_element(thread_counts.begin(), thread_counts.end());
+  if (max_threads == 0 || max_threads > MaxSigningThreads) {
+    throw std::runtime_error(fmt::format("Thread counts must be in [1, {}]", MaxSigningThreads));
+  }
+  if (batch == 0) {
+    throw std::runtime_error("Batch must be at least 1");
+  }
+
+  auto &store = memstore::MemoryStore::getInstance();
+  Dsig dsig{local_id};
+
+  if (local_id == 1) {
+    SigningThreads signing_threads{dsig, max_threads, batch, cores};
+    // Bursts never exhaust the SKs handed to a thread so that we measure the
+    // handoff rather than the background key generation.
+    auto const burst = std::max(PreparedSks / (2 * max_threads), 1ul);
+    for (auto const nb_threads : thread_counts) {
+      std::vector<std::chrono::nanoseconds> latencies;
+      for (size_t r = 0; r < rounds; r++) {
+        while (!dsig.replenished_sks());
+        auto const burst_latencies = signing_threads.burst(nb_threads, burst);
+        latencies.insert(latencies.end(), burst_latencies.begin(), burst_latencies.end());
+      }
+      std::sort(latencies.begin(), latencies.end());
+      fmt::print("[Threads={}/Burst={}/Batch={}/Sigs={}] sign latency p50: {} p90: {} p99: {} p99.9: {}\n",
+                 nb_threads, burst, batch, latencies.size(), percentile(latencies, 50),
+                 percentile(latencies, 90), percentile(latencies, 99),
+                 percentile(latencies, 99.9));
+    }
+  }
+
+  // Keep the bg pipelines alive until the signer is done.
+  store.barrier("sign_mt_done", nb_procs);
+
+  fmt::print("###DONE###\n");
+  return 0;
+}
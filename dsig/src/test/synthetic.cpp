@@ -253,6 +253,7 @@ int main(int argc, char* argv[]) {
   size_t timeout_s = 15;
   size_t clients = 1;
   size_t processing_ns = 1000;
+  long verify_budget_ns = -1;
 
   cli.add_argument(lyra::help(get_help))
       .add_argument(lyra::opt(scheme, "dsig,sodium,dalek,none")
@@ -304,7 +305,11 @@ int main(int argc, char* argv[]) {
       .add_argument(lyra::opt(worker_cores, "worker-cores")
                         .name("-w")
                         .name("--worker-core")
-                        .help("ID of one of the worker cores"));
+                        .help("ID of one of the worker cores"))
+      .add_argument(lyra::opt(verify_budget_ns, "verify budget in ns")
+                        .name("-B")
+                        .name("--verify-budget")
+                        .help("Time to wait for missing PKs before verifying on the slow path (default: forever)"));
 
   // Parse the program arguments.
   auto result = cli.parse({argc, argv});
@@ -350,6 +355,9 @@ int main(int argc, char* argv[]) {
   std::optional<Dsig> dsig;
   if (scheme == "dsig") {
     dsig.emplace(local_id);
+    if (verify_budget_ns >= 0) {
+      dsig->set_verify_budget(std::chrono::nanoseconds(verify_budget_ns));
+    }
   }
   pin_main(core_id);
   std::vector<ProcId> server_id{{1}};
@@ -418,6 +426,11 @@ int main(int argc, char* argv[]) {
   } else {
     fmt::print(timed_out ? "timeout\n" : "success\n");
   }
+  if (dsig) {
+    auto const stats = dsig->verify_stats();
+    fmt::print("[Sig={}/Path={}] verifications fast: {} waited: {} slow: {}\n",
+               scheme, to_string(path), stats.fast, stats.waited, stats.slow);
+  }
   fmt::print("###DONE###\n");
   return timed_out ? 1 : 0;
 }
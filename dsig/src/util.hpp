@@ -5,7 +5,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 
 #include <xxhash.h>
 #include <fmt/core.h>
@@ -15,9 +17,10 @@
 #include <dory/crypto/hash/siphash.hpp>
 #include <dory/crypto/hash/haraka.hpp>
 
+#include "export/namespace.hpp"
 #include "types.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 template <typename Duration>
 static void busy_sleep(Duration duration) {
   auto const start = std::chrono::steady_clock::now();
@@ -33,17 +36,43 @@ void prefetch(T const& t) {
   }
 }
 
+// Unlike `prefetch`, does not wait for the cache lines to be loaded.
+template <typename T>
+void prefetch_hint(T const& t) {
+  static size_t constexpr CacheLineSize{64};
+  for (size_t offset = 0; offset < sizeof(T); offset += CacheLineSize) {
+    __builtin_prefetch(reinterpret_cast<uint8_t const*>(&t) + offset);
+  }
+}
+
+// The tweak distinguishes the hashes of the different secrets and depths.
+static uint32_t secret_tweak(size_t const index, size_t const depth = 0) {
+  return static_cast<uint32_t>(index + SecretsPerSecretKey * depth);
+}
+
 // Blake3
-struct SaltedBlake3Secret {
-  Nonce nonce;
-  Secret secret;
-  uint32_t suffix;
+// Padded to a full block so that secrets can be hashed by `blake3_many` (and
+// so that no uninitialized byte gets hashed). The multi-lane kernels only take
+// whole blocks, so the zeros are part of the hashed input: the chains (thus the
+// PKs and signatures) differ from those of the unpadded 36/40-byte layout of
+// earlier versions, with which they do not interoperate.
+union PaddedSaltedBlake3Secret {
+  crypto::hash::Blake3Block padding;
+  struct SaltedBlake3Secret {
+    Nonce nonce;
+    Secret secret;
+    uint32_t suffix;
+  } salted_secret;
 };
 
+static thread_local PaddedSaltedBlake3Secret cached_blake3_secret { 0 };
 template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == Blake3, bool> = true>
 static SecretHash hash_secret(Secret const& secret, Nonce const& nonce, size_t const index, size_t const depth = 0) {
-  SaltedBlake3Secret to_hash {nonce, secret, static_cast<uint32_t>(index + SecretsPerSecretKey * depth)};
-  return crypto::hash::blake3<SecretHash>(to_hash);
+  auto& [cached_nonce, cached_secret, cached_suffix] = cached_blake3_secret.salted_secret;
+  cached_nonce = nonce;
+  cached_secret = secret;
+  cached_suffix = secret_tweak(index, depth);
+  return crypto::hash::blake3<SecretHash>(cached_blake3_secret);
 }
 
 // SHA256
@@ -60,13 +89,14 @@ template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == SHA256, bool
 static SecretHash hash_secret(Secret const& secret, Nonce const& nonce, size_t const index, size_t const depth = 0) {
   auto& [cached_nonce, cached_secret] = cached_sha256_secret.salted_secret;
   cached_nonce = nonce;
-  *reinterpret_cast<uint32_t*>(&cached_nonce) += static_cast<uint32_t>(index + SecretsPerSecretKey * depth);
+  *reinterpret_cast<uint32_t*>(&cached_nonce) += secret_tweak(index, depth);
   cached_secret = secret;
   return crypto::hash::sha256<SecretHash>(cached_sha256_secret);
 }
 
 // Haraka
-union PaddedSaltedHarakaSecret {
+// Haraka uses aligned loads.
+union alignas(16) PaddedSaltedHarakaSecret {
   std::array<uint8_t, 64> padding;
   struct SaltedHarakaSecret {
     Nonce nonce;
@@ -79,24 +109,11 @@ template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == Haraka, bool
 static SecretHash hash_secret(Secret const& secret, Nonce const& nonce, size_t const index, size_t const depth = 0) {
   auto& [cached_nonce, cached_secret] = cached_haraka_secret.salted_secret;
   cached_nonce = nonce;
-  *reinterpret_cast<uint32_t*>(&cached_nonce) += static_cast<uint32_t>(index + SecretsPerSecretKey * depth);
+  *reinterpret_cast<uint32_t*>(&cached_nonce) += secret_tweak(index, depth);
   cached_secret = secret;
   return crypto::hash::haraka<SecretHash>(cached_haraka_secret);
 }
 
-using Secret4x = std::array<Secret, 4>;
-using SecretHash4x = std::array<SecretHash, 4>;
-static thread_local std::array<PaddedSaltedHarakaSecret, 4> cached_haraka_secrets { 0 };
-static SecretHash4x hash_secret_haraka_4x(Secret4x const& secrets, Nonce const& nonce, size_t const index, size_t const depth = 0) {
-  for (size_t i = 0; i < 4; i++) {
-    auto& [cached_nonce, cached_secret] = cached_haraka_secrets.at(i).salted_secret;
-    cached_nonce = nonce;
-    *reinterpret_cast<uint32_t*>(&cached_nonce) += static_cast<uint32_t>(index + i + SecretsPerSecretKey * depth);
-    cached_secret = secrets.at(i);
-  }
-  return crypto::hash::haraka_4x<SecretHash4x>(cached_haraka_secrets);
-}
-
 // SipHash
 struct SuffixedNonce {
   Nonce nonce;
@@ -105,10 +122,130 @@ struct SuffixedNonce {
 
 template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == SipHash, bool> = true>
 static SecretHash hash_secret(Secret const& secret, Nonce const& nonce, size_t const index, size_t const depth = 0) {
-  SuffixedNonce msg {nonce, static_cast<uint32_t>(index + SecretsPerSecretKey * depth)};
+  SuffixedNonce msg {nonce, secret_tweak(index, depth)};
   return crypto::hash::siphash<SecretHash>(msg, secret.data());
 }
 
+// Multi-lane hashing
+template<HashingSchemes> struct SchemeToLanes;
+// blake3 picks AVX-512 (16 lanes), AVX2 (8) or SSE4.1 (4) at runtime.
+template<> struct SchemeToLanes<Blake3> { static size_t constexpr Lanes = 16; };
+template<> struct SchemeToLanes<SipHash> { static size_t constexpr Lanes = 4; };
+template<> struct SchemeToLanes<Haraka> { static size_t constexpr Lanes = 4; };
+template<> struct SchemeToLanes<SHA256> { static size_t constexpr Lanes = 8; };
+static size_t constexpr HashLanes = SchemeToLanes<HashingScheme>::Lanes;
+
+// Lane i computes `*outs[i] = hash_secret(*secrets[i], *nonces[i], tweaks[i])`.
+struct SecretLanes {
+  std::array<Secret const*, HashLanes> secrets;
+  std::array<Nonce const*, HashLanes> nonces;
+  std::array<uint32_t, HashLanes> tweaks;
+  std::array<SecretHash*, HashLanes> outs;
+  size_t size{0};
+};
+
+static thread_local std::array<PaddedSaltedBlake3Secret, SchemeToLanes<Blake3>::Lanes> cached_blake3_secrets {};
+template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == Blake3, bool> = true>
+static void hash_secret_Nx(SecretLanes const& lanes) {
+  std::array<crypto::hash::Blake3Block const*, HashLanes> inputs;
+  for (size_t i = 0; i < lanes.size; i++) {
+    auto& [cached_nonce, cached_secret, cached_suffix] = cached_blake3_secrets[i].salted_secret;
+    cached_nonce = *lanes.nonces[i];
+    cached_secret = *lanes.secrets[i];
+    cached_suffix = lanes.tweaks[i];
+    inputs[i] = &cached_blake3_secrets[i].padding;
+  }
+  std::array<crypto::hash::Blake3Hash, HashLanes> hashes;
+  crypto::hash::blake3_many(inputs.data(), lanes.size, hashes.data());
+  for (size_t i = 0; i < lanes.size; i++) {
+    std::memcpy(lanes.outs[i]->data(), hashes[i].data(), sizeof(SecretHash));
+  }
+}
+
+static thread_local std::array<PaddedSaltedSha256Secret, SchemeToLanes<SHA256>::Lanes> cached_sha256_secrets {};
+template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == SHA256, bool> = true>
+static void hash_secret_Nx(SecretLanes const& lanes) {
+  for (size_t i = 0; i < lanes.size; i++) {
+    auto& [cached_nonce, cached_secret] = cached_sha256_secrets[i].salted_secret;
+    cached_nonce = *lanes.nonces[i];
+    *reinterpret_cast<uint32_t*>(&cached_nonce) += lanes.tweaks[i];
+    cached_secret = *lanes.secrets[i];
+  }
+  auto const hashes = crypto::hash::sha256_8x(cached_sha256_secrets);
+  for (size_t i = 0; i < lanes.size; i++) {
+    std::memcpy(lanes.outs[i]->data(), hashes[i].data(), sizeof(SecretHash));
+  }
+}
+
+using SecretHash4x = std::array<SecretHash, 4>;
+static thread_local std::array<PaddedSaltedHarakaSecret, SchemeToLanes<Haraka>::Lanes> cached_haraka_secrets {};
+template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == Haraka, bool> = true>
+static void hash_secret_Nx(SecretLanes const& lanes) {
+  for (size_t i = 0; i < lanes.size; i++) {
+    auto& [cached_nonce, cached_secret] = cached_haraka_secrets[i].salted_secret;
+    cached_nonce = *lanes.nonces[i];
+    *reinterpret_cast<uint32_t*>(&cached_nonce) += lanes.tweaks[i];
+    cached_secret = *lanes.secrets[i];
+  }
+  auto const hashes = crypto::hash::haraka_4x<SecretHash4x>(cached_haraka_secrets);
+  for (size_t i = 0; i < lanes.size; i++) {
+    *lanes.outs[i] = hashes[i];
+  }
+}
+
+template <HashingSchemes hs = HashingScheme, std::enable_if_t<hs == SipHash, bool> = true>
+static void hash_secret_Nx(SecretLanes const& lanes) {
+  if constexpr (!std::is_same_v<SecretHash, crypto::hash::SipHash>) {
+    throw std::runtime_error("The only valid output is SipHash!");
+  } else {
+    std::array<SuffixedNonce, 4> msgs{};
+    std::array<std::array<uint8_t, 16>, 4> keys{};
+    for (size_t i = 0; i < lanes.size; i++) {
+      msgs[i] = {*lanes.nonces[i], lanes.tweaks[i]};
+      std::memcpy(keys[i].data(), lanes.secrets[i]->data(), keys[i].size());
+    }
+    auto const hashes = crypto::hash::siphash_4x(msgs, keys);
+    for (size_t i = 0; i < lanes.size; i++) {
+      *lanes.outs[i] = hashes[i];
+    }
+  }
+}
+
+/**
+ * @brief Collects independent secrets to hash and hashes them `HashLanes` at a
+ *        time via `hash_secret_Nx`.
+ *
+ * Inputs are only read when the lanes are flushed: a secret that depends on
+ * the hash of another one must only be pushed after a `flush`.
+ */
+class SecretHasher {
+ public:
+  void push(Secret const& secret, Nonce const& nonce, size_t const index,
+            size_t const depth, SecretHash& out) {
+    auto const i = lanes.size++;
+    lanes.secrets[i] = &secret;
+    lanes.nonces[i] = &nonce;
+    lanes.tweaks[i] = secret_tweak(index, depth);
+    lanes.outs[i] = &out;
+    if (lanes.size == HashLanes) {
+      flush();
+    }
+  }
+
+  void flush() {
+    if (lanes.size == 1) {
+      // The tweak already accounts for the depth.
+      *lanes.outs[0] = hash_secret(*lanes.secrets[0], *lanes.nonces[0], lanes.tweaks[0]);
+    } else if (lanes.size > 1) {
+      hash_secret_Nx(lanes);
+    }
+    lanes.size = 0;
+  }
+
+ private:
+  SecretLanes lanes;
+};
+
 static Nonce sk_nonce(Seed const& seed) {
   auto hasher = crypto::hash::blake3_init();
   crypto::hash::blake3_update(hasher, 0x5EED);
@@ -136,4 +273,4 @@ std::array<uint8_t, DestSize> pad(std::array<T, SrcSize> const& src) {
   std::copy(src.begin(), src.end(), dst.begin());
   return dst;
 }
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
@@ -1,14 +1,129 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
-namespace dory::dsig {
+#include <dory/shared/logger.hpp>
+#include <dory/shared/pinning.hpp>
+#include <dory/third-party/sync/mpmc.hpp>
 
+#include "export/namespace.hpp"
+#include "pinning.hpp"
+
+namespace dory::DSIG_NS {
+
+/**
+ * @brief Pool of pinned threads that run the background computations (SK
+ *        generation, batch signing and PK checking).
+ *
+ * With 0 workers, the work is run inline by the scheduling thread.
+ * Worker `i` is named `worker<i>` and is pinned according to DSIG_CORES.
+ *
+ * A task that throws does not take the process down: its exception is handed
+ * to the `on_failure` of the task, if any, and logged otherwise.
+ */
 class Workers {
-public:
-  void schedule(std::function<void()>work) {
-    work();
+  using Task = std::function<void()>;
+  // Runs on the worker, with the exception thrown by the task.
+  using OnFailure = std::function<void(std::exception_ptr)>;
+
+  struct Job {
+    Task work;
+    OnFailure on_failure;
+  };
+
+ public:
+  Workers(size_t const nb_workers = 0) {
+    for (size_t i = 0; i < nb_workers; i++) {
+      threads.emplace_back([this] { work_loop(); });
+      auto const thread_name = "worker" + std::to_string(i);
+      set_thread_name(threads.back(), thread_name.c_str());
+      if (auto const core = get_core(thread_name)) {
+        pin_thread_to_core(threads.back(), *core);
+      }
+    }
   }
+
+  ~Workers() { stop(); }
+
+  // As the threads capture `this`, the pool should not be moved.
+  Workers(Workers const &) = delete;
+  Workers &operator=(Workers const &) = delete;
+  Workers(Workers &&) = delete;
+  Workers &operator=(Workers &&) = delete;
+
+  void schedule(Task work, OnFailure on_failure = nullptr) {
+    Job job{std::move(work), std::move(on_failure)};
+    if (threads.empty()) {
+      run(job);
+      return;
+    }
+    if (!tasks.enqueue(std::move(job))) {
+      throw std::runtime_error("Could not enqueue work to the workers.");
+    }
+  }
+
+  size_t size() const { return threads.size(); }
+
+  /**
+   * @brief Joins the workers. Tasks that have not started yet are dropped.
+   *
+   * Must be called before destroying the objects referenced by the tasks.
+   */
+  void stop() {
+    stopped = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+  }
+
+ private:
+  void run(Job &job) {
+    try {
+      job.work();
+    } catch (...) {
+      if (job.on_failure) {
+        job.on_failure(std::current_exception());
+        return;
+      }
+      try {
+        throw;
+      } catch (std::exception const &e) {
+        LOGGER_ERROR(logger, "A background task failed: {}", e.what());
+      } catch (...) {
+        LOGGER_ERROR(logger, "A background task failed.");
+      }
+    }
+  }
+
+  void work_loop() {
+    size_t idle_loops = 0;
+    Job job;
+    while (!stopped.load(std::memory_order_relaxed)) {
+      if (tasks.try_dequeue(job)) {
+        run(job);
+        idle_loops = 0;
+        continue;
+      }
+      // We back off to prevent burning the core when there is nothing to do.
+      if (++idle_loops > 1024) {
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+      }
+    }
+  }
+
+  std::vector<std::thread> threads;
+  third_party::sync::MpmcQueue<Job> tasks;
+  std::atomic<bool> stopped{false};
+
+  LOGGER_DECL_INIT(logger, "Dsig::Workers");
 };
 
-}
\ No newline at end of file
+}  // namespace dory::DSIG_NS
@@ -7,22 +7,23 @@
 #include <dory/shared/branching.hpp>
 
 #include "config.hpp"
+#include "export/namespace.hpp"
+#include "message.hpp"
 #include "types.hpp"
 
-namespace dory::dsig {
+namespace dory::DSIG_NS {
 
 /**
  * @brief A hash large enough know which secrets to reveal.
  *
  */
 class WotsHash {
-  struct Prefix {
-    Hash pk_hash;
-    Nonce nonce;
-  };
  public:
-  WotsHash(Hash const& pk_hash, Nonce const& nonce, uint8_t const* const begin,
-           uint8_t const* const end) {
+  WotsHash(Hash const& pk_hash, Nonce const& nonce, MsgView const& msg)
+      : WotsHash(MsgHasher::prefixed(pk_hash, nonce, msg)) {}
+
+  // Finalizes a message that was hashed incrementally.
+  explicit WotsHash(MsgHasher const& hasher) {
     // Deviation from the original WOTS: we compute a larger hash
     // and use a subset of the bits aligned on bytes.
     static_assert(wots::LogSecretsDepth <= 8);
@@ -30,11 +31,7 @@ class WotsHash {
     std::array<uint8_t, 8> checksum = {};  // 8 is more than necessary
 
     // Computing the secret depths for L1
-    auto hasher = crypto::hash::blake3_init();
-    Prefix prefix = {pk_hash, nonce};
-    crypto::hash::blake3_update(hasher, prefix);
-    crypto::hash::blake3_update(hasher, begin, end);
-    crypto::hash::blake3_final_there(hasher, hash.data(), hash.size());
+    hasher.final(hash.data(), hash.size());
     uint64_t& csum = *reinterpret_cast<uint64_t*>(checksum.data());
     for (size_t secret = 0; secret < wots::L1; secret++) {
       static uint8_t constexpr SecretsDepthMask = SecretsDepth - 1;
@@ -65,4 +62,4 @@ class WotsHash {
   std::array<uint8_t, wots::SecretsPerSignature> secret_depths;
 };
 
-}  // namespace dory::dsig
+}  // namespace dory::DSIG_NS
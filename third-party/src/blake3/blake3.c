@@ -610,6 +610,13 @@ void blake3_hasher_finalize_seek(const blake3_hasher *self, uint64_t seek,
   output_root_bytes(&output, seek, out, out_len);
 }
 
+void blake3_hash_many_blocks(const uint8_t *const *inputs, size_t num_inputs,
+                             uint8_t *out) {
+  // Each input is a single-block chunk that is also the root of its tree.
+  blake3_hash_many(inputs, num_inputs, 1, IV, 0, false, 0, CHUNK_START,
+                   CHUNK_END | ROOT, out);
+}
+
 void blake3_hasher_reset(blake3_hasher *self) {
   chunk_state_reset(&self->chunk, self->key, 0);
   self->cv_stack_len = 0;
@@ -53,6 +53,12 @@ void blake3_hasher_finalize_seek(const blake3_hasher *self, uint64_t seek,
                                  uint8_t *out, size_t out_len);
 void blake3_hasher_reset(blake3_hasher *self);
 
+// Hashes `num_inputs` independent messages of exactly BLAKE3_BLOCK_LEN bytes
+// with the widest SIMD implementation supported by the CPU. The i-th
+// BLAKE3_OUT_LEN-byte hash is written at `out + i * BLAKE3_OUT_LEN`.
+void blake3_hash_many_blocks(const uint8_t *const *inputs, size_t num_inputs,
+                             uint8_t *out);
+
 #ifdef __cplusplus
 }
 #endif
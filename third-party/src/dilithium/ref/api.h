@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define pqcrystals_dilithium2_PUBLICKEYBYTES 1312
+#define pqcrystals_dilithium2_SECRETKEYBYTES 2528
+#define pqcrystals_dilithium2_BYTES 2420
+
+#define pqcrystals_dilithium2aes_ref_PUBLICKEYBYTES pqcrystals_dilithium2_PUBLICKEYBYTES
+#define pqcrystals_dilithium2aes_ref_SECRETKEYBYTES pqcrystals_dilithium2_SECRETKEYBYTES
+#define pqcrystals_dilithium2aes_ref_BYTES pqcrystals_dilithium2_BYTES
+
+int pqcrystals_dilithium2aes_ref_keypair(uint8_t *pk, uint8_t *sk);
+
+int pqcrystals_dilithium2aes_ref_signature(uint8_t *sig, size_t *siglen,
+                                          const uint8_t *m, size_t mlen,
+                                          const uint8_t *sk);
+
+int pqcrystals_dilithium2aes_ref(uint8_t *sm, size_t *smlen,
+                                const uint8_t *m, size_t mlen,
+                                const uint8_t *sk);
+
+int pqcrystals_dilithium2aes_ref_verify(const uint8_t *sig, size_t siglen,
+                                       const uint8_t *m, size_t mlen,
+                                       const uint8_t *pk);
+
+int pqcrystals_dilithium2aes_ref_open(uint8_t *m, size_t *mlen,
+                                     const uint8_t *sm, size_t smlen,
+                                     const uint8_t *pk);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
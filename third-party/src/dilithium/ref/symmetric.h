@@ -0,0 +1,28 @@
+#ifndef SYMMETRIC_H
+#define SYMMETRIC_H
+
+#include <stdint.h>
+#include "params.h"
+
+#ifdef DILITHIUM_USE_AES
+
+#include "aes256ctr.h"
+#include "fips202.h"
+
+typedef aes256ctr_ctx stream128_state;
+typedef aes256ctr_ctx stream256_state;
+
+#define STREAM128_BLOCKBYTES AES256CTR_BLOCKBYTES
+#define STREAM256_BLOCKBYTES AES256CTR_BLOCKBYTES
+
+/* The key is the first 32 bytes of the seed */
+#define stream128_init(STATE, SEED, NONCE) aes256ctr_init(STATE, SEED, NONCE)
+#define stream128_squeezeblocks(OUT, OUTBLOCKS, STATE) aes256ctr_squeezeblocks(OUT, OUTBLOCKS, STATE)
+#define stream256_init(STATE, SEED, NONCE) aes256ctr_init(STATE, SEED, NONCE)
+#define stream256_squeezeblocks(OUT, OUTBLOCKS, STATE) aes256ctr_squeezeblocks(OUT, OUTBLOCKS, STATE)
+
+#else
+#error "The portable Dilithium is only built with DILITHIUM_USE_AES"
+#endif
+
+#endif
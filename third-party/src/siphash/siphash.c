@@ -183,3 +183,31 @@ int tp_siphash(const void *in, const size_t inlen, const void *k, uint8_t *out,
 
     return 0;
 }
+
+/* AVX2 kernel, in siphash4x.c. */
+void tp_siphash_4x_avx2(const void *in, const size_t inlen, const void *k,
+                        uint8_t *out, const size_t outlen);
+
+/*
+    Computes 4 SipHash values
+    *in: 4 inputs of inlen bytes, stored back to back
+    *k: 4 keys of 16 bytes, stored back to back
+    *out: 4 outputs of outlen bytes, stored back to back
+    outlen: length of each output in bytes, must be 8 or 16
+
+    The AVX2 kernel is only used on CPUs that support it, 4 scalar calls are
+    made otherwise.
+*/
+void tp_siphash_4x(const void *in, const size_t inlen, const void *k,
+                   uint8_t *out, const size_t outlen) {
+    const unsigned char *ni = (const unsigned char *)in;
+    const unsigned char *kk = (const unsigned char *)k;
+
+    if (__builtin_cpu_supports("avx2")) {
+        tp_siphash_4x_avx2(in, inlen, k, out, outlen);
+        return;
+    }
+    for (int l = 0; l < 4; l++) {
+        tp_siphash(ni + l * inlen, inlen, kk + 16 * l, out + l * outlen, outlen);
+    }
+}
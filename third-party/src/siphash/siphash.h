@@ -27,6 +27,9 @@ extern "C" {
 int tp_siphash(const void *in, const size_t inlen, const void *k, uint8_t *out,
             const size_t outlen);
 
+void tp_siphash_4x(const void *in, const size_t inlen, const void *k,
+                   uint8_t *out, const size_t outlen);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file